@@ -0,0 +1,372 @@
+#include <wx/app.h>
+#include <wx/frame.h>
+#include <wx/cmdline.h>
+#include <wx/ffile.h>
+
+#include <chrono>
+#include <cmath>
+#include <random>
+#include <deque>
+#include <format>
+#include <algorithm>
+#include <functional>
+
+#include "image_panel.h"
+#include "box_index.h"
+#include "clipboard.h"
+#include "json_utils.h"
+#include "layout_serial.h"
+#include "wxintl.h"
+#include "variable_table_model.h"
+
+// Micro and macro benchmarks of the editor's hot paths.
+// Every input is generated from a fixed seed so that runs on the same machine are comparable,
+// results are written as JSON to stdout or to the file given with --out.
+
+constexpr uint32_t BENCH_SEED = 0x626c7365;
+constexpr size_t SYNTHETIC_BOXES = 10000;
+constexpr int SYNTHETIC_PAGES = 4;
+constexpr size_t HIT_TESTS_PER_ITERATION = 1000;
+constexpr size_t MAX_HISTORY_SIZE = 20;
+
+struct bench_result {
+    std::string name;
+    size_t iterations;
+    size_t items_per_iteration;
+    double mean_ns;
+    double median_ns;
+    double min_ns;
+    double max_ns;
+};
+
+class bench_runner {
+public:
+    bench_runner(double min_time, wxString filter)
+        : m_min_time(min_time), m_filter(std::move(filter)) {}
+
+    // runs fn until min_time seconds have elapsed, at least 5 times, after a warm up call
+    void run(const std::string &name, size_t items_per_iteration, const std::function<void()> &fn) {
+        if (!m_filter.empty() && wxString::FromUTF8(name).Find(m_filter) == wxNOT_FOUND) return;
+
+        using clock = std::chrono::steady_clock;
+        fn();
+
+        std::vector<double> samples;
+        auto begin = clock::now();
+        while (samples.size() < 5 || std::chrono::duration<double>(clock::now() - begin).count() < m_min_time) {
+            auto start = clock::now();
+            fn();
+            samples.push_back(std::chrono::duration<double, std::nano>(clock::now() - start).count());
+        }
+
+        std::ranges::sort(samples);
+        double total = 0;
+        for (double s : samples) total += s;
+
+        auto &result = m_results.emplace_back(name, samples.size(), items_per_iteration,
+            total / samples.size(), samples[samples.size() / 2], samples.front(), samples.back());
+        fputs(std::format("{:<48} {:>10} iters {:>14.0f} ns median\n", name, result.iterations, result.median_ns).c_str(), stderr);
+    }
+
+    std::string to_json() const {
+        std::string out = std::format("{{\"version\":1,\"seed\":{},\"wx_version\":", BENCH_SEED);
+        append_json_string(out, wxVERSION_NUM_DOT_STRING);
+        out += ",\"benchmarks\":[";
+        for (const auto &result : m_results) {
+            if (&result != m_results.data()) out += ',';
+            out += "{\"name\":";
+            append_json_string(out, result.name);
+            out += std::format(",\"iterations\":{},\"items_per_iteration\":{},"
+                "\"mean_ns\":{:.1f},\"median_ns\":{:.1f},\"min_ns\":{:.1f},\"max_ns\":{:.1f}}}",
+                result.iterations, result.items_per_iteration,
+                result.mean_ns, result.median_ns, result.min_ns, result.max_ns);
+        }
+        out += "]}\n";
+        return out;
+    }
+
+private:
+    double m_min_time;
+    wxString m_filter;
+    std::vector<bench_result> m_results;
+};
+
+// keeps the compiler from discarding the result of a benchmarked call
+template<typename T>
+static void do_not_optimize(const T &value) {
+    static volatile const void *sink;
+    sink = &value;
+}
+
+// a text-like page: runs of dark glyphs on regularly spaced lines
+static std::shared_ptr<page_raster> make_synthetic_page(int width, int height, std::mt19937 &rng) {
+    auto raster = std::make_shared<page_raster>(width, height, 3);
+    std::fill_n(raster->data(), raster->size_bytes(), uint8_t(0xff));
+    std::uniform_int_distribution<int> glyph(2, 12);
+    for (int line = height / 20; line + 30 < height - height / 20; line += 40) {
+        for (int x = width / 20; x < width - width / 20;) {
+            int w = glyph(rng);
+            for (int y = line; y < line + 24; ++y) {
+                std::fill_n(raster->data() + y * raster->stride() + x * 3, w * 3, uint8_t(0x20));
+            }
+            x += w + glyph(rng);
+        }
+    }
+    return raster;
+}
+
+static layout_box_list make_synthetic_layout(size_t count, std::mt19937 &rng) {
+    layout_box_list layout;
+    std::uniform_real_distribution<float> coord(0.f, 0.95f);
+    std::uniform_real_distribution<float> size(0.005f, 0.05f);
+    for (size_t i = 0; i < count; ++i) {
+        layout_box &box = layout.emplace_back();
+        box.x = coord(rng);
+        box.y = coord(rng);
+        box.w = size(rng);
+        box.h = size(rng);
+        box.page = int(i % SYNTHETIC_PAGES) + 1;
+        box.name = std::format("box_{}", i);
+        box.script = std::format("field_{} = trim($);\n", i);
+    }
+    return layout;
+}
+
+// same tests as box_editor_panel::getBoxAt, with and without the grid index
+static layout_box *hit_test(box_index &index, int page, float x, float y, std::vector<layout_box *> &candidates) {
+    candidates.clear();
+    index.query(page, x, y, x, y, candidates);
+    for (layout_box *box : candidates) {
+        if (x > box->x && x < box->x + box->w && y > box->y && y < box->y + box->h) return box;
+    }
+    return nullptr;
+}
+
+static layout_box *hit_test_linear(layout_box_list &layout, int page, float x, float y) {
+    for (layout_box &box : layout) {
+        if (x > box.x && x < box.x + box.w && y > box.y && y < box.y + box.h && box.page == page) return &box;
+    }
+    return nullptr;
+}
+
+// same window as box_editor_panel::getBoxResizeNode, at a 1000px page width
+static size_t resize_candidates(box_index &index, int page, float x, float y, std::vector<layout_box *> &candidates) {
+    constexpr float tolerance = 8.f / 1000.f;
+    candidates.clear();
+    index.query(page, x - tolerance, y - tolerance, x + tolerance, y + tolerance, candidates);
+    return candidates.size();
+}
+
+static variable_map make_synthetic_table(size_t count) {
+    variable_map table;
+    for (size_t i = 0; i < count; ++i) {
+        table.emplace(std::format("variable_{}", i), variable(std::format("value of variable {}", i)));
+    }
+    return table;
+}
+
+class BenchApp : public wxApp {
+public:
+    virtual void OnInitCmdLine(wxCmdLineParser &parser) override {
+        parser.AddOption("p", "input-pdf", "PDF file for the render benchmarks");
+        parser.AddOption("o", "out", "JSON output file, stdout if missing");
+        parser.AddOption("f", "filter", "runs only the benchmarks whose name contains this string");
+        parser.AddOption("t", "min-time", "minimum seconds per benchmark", wxCMD_LINE_VAL_DOUBLE);
+    }
+
+    virtual bool OnCmdLineParsed(wxCmdLineParser &parser) override {
+        parser.Found("p", &m_pdf_filename);
+        parser.Found("o", &m_out_filename);
+        parser.Found("f", &m_filter);
+        parser.Found("t", &m_min_time);
+        return true;
+    }
+
+    virtual int OnRun() override;
+
+private:
+    void bench_render(bench_runner &runner);
+    void bench_rescale(bench_runner &runner);
+    void bench_hit_test(bench_runner &runner);
+    void bench_history(bench_runner &runner);
+    void bench_variable_table(bench_runner &runner);
+    void bench_clipboard(bench_runner &runner);
+
+private:
+    wxString m_pdf_filename;
+    wxString m_out_filename;
+    wxString m_filter;
+    double m_min_time = 0.5;
+};
+
+wxIMPLEMENT_APP(BenchApp);
+
+int BenchApp::OnRun() {
+    bench_runner runner(m_min_time, m_filter);
+
+    bench_render(runner);
+    bench_rescale(runner);
+    bench_hit_test(runner);
+    bench_history(runner);
+    bench_variable_table(runner);
+    bench_clipboard(runner);
+
+    std::string json = runner.to_json();
+    if (m_out_filename.empty()) {
+        fputs(json.c_str(), stdout);
+    } else {
+        wxFFile file(m_out_filename, "wb");
+        if (!file.IsOpened() || !file.Write(json.data(), json.size())) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+void BenchApp::bench_render(bench_runner &runner) {
+    if (m_pdf_filename.empty()) return;
+
+    pdf_document doc;
+    try {
+        doc.open(m_pdf_filename.ToStdString());
+    } catch (const std::exception &error) {
+        fputs(std::format("Can't open {}: {}\n", m_pdf_filename.ToStdString(), error.what()).c_str(), stderr);
+        return;
+    }
+    for (int rotation : {0, 1}) {
+        runner.run(std::format("render_page/rotation:{}", rotation), 1, [&]{
+            page_raster raster(doc.render_page(1, rotation));
+            do_not_optimize(raster);
+        });
+    }
+}
+
+void BenchApp::bench_rescale(bench_runner &runner) {
+    std::mt19937 rng(BENCH_SEED);
+    auto page = make_synthetic_page(2480, 3508, rng);
+
+    // the panel needs a parent window, it is never shown
+    auto *frame = new wxFrame(nullptr, wxID_ANY, "blseditor_bench");
+    auto *panel = new wxImagePanel(frame);
+
+    runner.run("image_panel/set_image", 1, [&]{
+        panel->setImage(page);
+    });
+    for (float zoom : {0.25f, 0.5f, 1.f}) {
+        runner.run(std::format("image_panel/rescale/zoom:{}/normal", zoom), 1, [&]{
+            panel->rescale(zoom, wxIMAGE_QUALITY_NORMAL);
+        });
+        runner.run(std::format("image_panel/rescale/zoom:{}/high", zoom), 1, [&]{
+            panel->rescale(zoom, wxIMAGE_QUALITY_HIGH);
+        });
+    }
+
+    frame->Destroy();
+}
+
+void BenchApp::bench_hit_test(bench_runner &runner) {
+    std::mt19937 rng(BENCH_SEED);
+    layout_box_list layout = make_synthetic_layout(SYNTHETIC_BOXES, rng);
+
+    std::uniform_real_distribution<float> coord(0.f, 1.f);
+    std::vector<std::pair<float, float>> points(HIT_TESTS_PER_ITERATION);
+    for (auto &[x, y] : points) {
+        x = coord(rng);
+        y = coord(rng);
+    }
+
+    box_index index;
+    runner.run("box_index/build/boxes:10000", 1, [&]{
+        index.build(layout);
+    });
+
+    std::vector<layout_box *> candidates;
+    runner.run("hit_test/get_box_at/indexed", HIT_TESTS_PER_ITERATION, [&]{
+        for (auto [x, y] : points) {
+            do_not_optimize(hit_test(index, 1, x, y, candidates));
+        }
+    });
+    runner.run("hit_test/get_box_at/linear", HIT_TESTS_PER_ITERATION, [&]{
+        for (auto [x, y] : points) {
+            do_not_optimize(hit_test_linear(layout, 1, x, y));
+        }
+    });
+    runner.run("hit_test/get_box_resize_node/indexed", HIT_TESTS_PER_ITERATION, [&]{
+        for (auto [x, y] : points) {
+            do_not_optimize(resize_candidates(index, 1, x, y, candidates));
+        }
+    });
+}
+
+void BenchApp::bench_history(bench_runner &runner) {
+    std::mt19937 rng(BENCH_SEED);
+    layout_box_list layout = make_synthetic_layout(SYNTHETIC_BOXES, rng);
+
+    // same bookkeeping as frame_editor::updateLayout, with a full undo stack
+    std::deque<layout_box_list> history;
+    runner.run("update_layout/history_push/boxes:10000", 1, [&]{
+        layout.front().x = std::fmod(layout.front().x + 0.001f, 0.9f);
+        history.push_back(layout);
+        if (history.size() > MAX_HISTORY_SIZE) {
+            history.pop_front();
+        }
+    });
+}
+
+void BenchApp::bench_variable_table(bench_runner &runner) {
+    std::vector<variable_map> tables;
+    for (int i = 0; i < 10; ++i) {
+        tables.push_back(make_synthetic_table(1000));
+    }
+
+    wxObjectDataPtr<VariableTableModel> model(new VariableTableModel);
+    runner.run("variable_table_model/add_tables/vars:10000", tables.size() * 1000, [&]{
+        model->ClearTables();
+        for (size_t i = 0; i < tables.size(); ++i) {
+            model->AddTable(std::format("table_{}", i), tables[i]);
+        }
+    });
+
+    runner.run("variable_table_model/build_index/vars:10000", tables.size() * 1000, [&]{
+        model->BuildIndex();
+    });
+
+    // one search per keystroke of the search box
+    runner.run("variable_table_model/search/vars:10000", 1, [&]{
+        do_not_optimize(model->Search("variable_12"));
+    });
+    model->Search("");
+}
+
+void BenchApp::bench_clipboard(bench_runner &runner) {
+    std::mt19937 rng(BENCH_SEED);
+    layout_box_list layout = make_synthetic_layout(100, rng);
+    std::vector<layout_box> boxes(layout.begin(), layout.end());
+
+    runner.run("clipboard/json_round_trip/boxes:100", boxes.size(), [&]{
+        auto copied = BoxesFromJson(BoxesToJson(boxes));
+        do_not_optimize(copied);
+    });
+
+    // the binary flavour of the clipboard encodes every box with write_box
+    runner.run("clipboard/binary_round_trip/boxes:100", boxes.size(), [&]{
+        binary_writer writer;
+        for (const auto &box : boxes) {
+            writer.write_box(box);
+        }
+        binary_reader reader(writer.data());
+        std::vector<layout_box> copied;
+        while (!reader.at_end()) {
+            copied.push_back(reader.read_box());
+        }
+        do_not_optimize(copied);
+    });
+
+    runner.run("clipboard/system_round_trip/boxes:100", boxes.size(), [&]{
+        std::vector<layout_box> copied;
+        if (SetClipboard(boxes)) {
+            GetClipboard(copied);
+        }
+        do_not_optimize(copied);
+    });
+}
\ No newline at end of file
@@ -4,11 +4,25 @@
 
 #include <wx/choicdlg.h>
 #include <wx/dcbuffer.h>
+#include <wx/graphics.h>
 
 #include "move_page_dialog.h"
+#include "perf_counters.h"
+#include "memory_budget.h"
 
 using namespace enums::flag_operators;
 
+enum {
+    TIMER_NUDGE = 20100, TIMER_HUD
+};
+
+// arrow key nudges are committed as a single edit once the keys are idle for this long
+constexpr int NUDGE_COMMIT_DELAY = 400;
+
+constexpr int HUD_REFRESH_INTERVAL = 250;
+constexpr int HUD_MARGIN = 8;
+constexpr int HUD_PADDING = 4;
+
 BEGIN_EVENT_TABLE(box_editor_panel, wxImagePanel)
     EVT_LEFT_DOWN(box_editor_panel::OnMouseDown)
     EVT_LEFT_UP(box_editor_panel::OnMouseUp)
@@ -16,9 +30,12 @@ BEGIN_EVENT_TABLE(box_editor_panel, wxImagePanel)
     EVT_MOTION(box_editor_panel::OnMouseMove)
     EVT_KEY_DOWN(box_editor_panel::OnKeyDown)
     EVT_KEY_UP(box_editor_panel::OnKeyUp)
+    EVT_TIMER(TIMER_NUDGE, box_editor_panel::OnNudgeTimer)
+    EVT_TIMER(TIMER_HUD, box_editor_panel::OnHudTimer)
+    EVT_SCROLLWIN(box_editor_panel::OnScrollWin)
 END_EVENT_TABLE()
 
-box_editor_panel::box_editor_panel(wxWindow *parent, frame_editor *app) : wxImagePanel(parent), app(app) {
+box_editor_panel::box_editor_panel(wxWindow *parent, frame_editor *app) : wxImagePanel(parent), app(app), nudge_timer(this, TIMER_NUDGE), hud_timer(this, TIMER_HUD) {
     info_dialog = new TextDialog(this, wxintl::translate("TEST_OUTPUT"));
 }
 
@@ -42,26 +59,63 @@ static void clamp_rect(pdf_rect &rect) {
 void box_editor_panel::render(wxDC &dc) {
     wxImagePanel::render(dc);
 
-    dc.SetBrush(*wxTRANSPARENT_BRUSH);
-    for (auto &box : app->layout) {
-        if (box.page == app->getSelectedPage()) {
-            if (selected_box == &box) {
-                dc.SetPen(*wxBLACK_DASHED_PEN);
-            } else {
-                dc.SetPen(*wxBLACK_PEN);
+    // only the boxes inside the repainted area are drawn, one path per pen
+    auto visible = getBoxesIn(
+        m_dirty_rect.GetLeft() / scaled_width(), m_dirty_rect.GetTop() / scaled_height(),
+        m_dirty_rect.GetRight() / scaled_width(), m_dirty_rect.GetBottom() / scaled_height());
+
+    auto box_rect = [&](const layout_box &box) {
+        double x0 = std::max(box.x, 0.f) * scaled_width();
+        double y0 = std::max(box.y, 0.f) * scaled_height();
+        double x1 = std::min(box.x + box.w, 1.f) * scaled_width();
+        double y1 = std::min(box.y + box.h, 1.f) * scaled_height();
+        return wxRect(int(x0), int(y0), int(x1 - x0), int(y1 - y0));
+    };
+
+    if (heatmap_visible && heat_generation == app->getLayoutGeneration()) {
+        renderHeatmap(dc, visible);
+    }
+
+    std::unique_ptr<wxGraphicsContext> gc;
+    if (auto *mem_dc = dynamic_cast<wxMemoryDC *>(&dc)) {
+        gc.reset(wxGraphicsContext::Create(*mem_dc));
+    }
+    if (gc) {
+        gc->SetAntialiasMode(wxANTIALIAS_NONE);
+        wxGraphicsPath normal_path = gc->CreatePath();
+        wxGraphicsPath selected_path = gc->CreatePath();
+        for (layout_box *box : visible) {
+            wxRect r = box_rect(*box);
+            (app->isBoxSelected(box) ? selected_path : normal_path).AddRectangle(r.x, r.y, r.width, r.height);
+        }
+        gc->SetPen(*wxBLACK_PEN);
+        gc->StrokePath(normal_path);
+        gc->SetPen(*wxBLACK_DASHED_PEN);
+        gc->StrokePath(selected_path);
+        gc.reset();
+    } else {
+        dc.SetBrush(*wxTRANSPARENT_BRUSH);
+        for (bool selected : {false, true}) {
+            dc.SetPen(selected ? *wxBLACK_DASHED_PEN : *wxBLACK_PEN);
+            for (layout_box *box : visible) {
+                if (app->isBoxSelected(box) == selected) {
+                    dc.DrawRectangle(box_rect(*box));
+                }
             }
-            pdf_rect r = box;
-            clamp_rect(r);
-            dc.DrawRectangle(
-                r.x * scaled_width(),
-                r.y * scaled_height(),
-                r.w * scaled_width(),
-                r.h * scaled_height()
-            );
         }
     }
 
+    dc.SetBrush(*wxTRANSPARENT_BRUSH);
     switch (selected_tool) {
+    case TOOL_SELECT:
+        if (mouseIsDown && rubber_band) {
+            dc.SetPen(*wxBLACK_DASHED_PEN);
+            dc.DrawRectangle(wxRect (
+                wxPoint(start_pt.x * scaled_width(), start_pt.y * scaled_height()),
+                wxPoint(end_pt.x * scaled_width(), end_pt.y * scaled_height())
+            ));
+        }
+        break;
     case TOOL_NEWBOX:
     case TOOL_TEST:
         if (mouseIsDown) {
@@ -73,6 +127,165 @@ void box_editor_panel::render(wxDC &dc) {
         }
         break;
     }
+
+    if (hud_visible) {
+        renderHud(dc);
+    }
+}
+
+void box_editor_panel::setHudVisible(bool visible) {
+    hud_visible = visible;
+    if (visible) {
+        hud_timer.Start(HUD_REFRESH_INTERVAL);
+    } else {
+        hud_timer.Stop();
+    }
+    Refresh();
+}
+
+void box_editor_panel::OnHudTimer(wxTimerEvent &evt) {
+    RefreshRect(wxRect(wxPoint(HUD_MARGIN, HUD_MARGIN), hud_size), false);
+}
+
+// scrolling moves the pixels of the overlay along with the page, the copy is painted over once the view has moved
+void box_editor_panel::OnScrollWin(wxScrollWinEvent &evt) {
+    evt.Skip();
+    if (!hud_visible) return;
+
+    wxPoint old_origin = CalcUnscrolledPosition(wxPoint(0, 0));
+    CallAfter([this, old_origin] {
+        wxRect hud_rect(wxPoint(HUD_MARGIN, HUD_MARGIN), hud_size);
+        RefreshRect(wxRect(hud_rect).Offset(old_origin - CalcUnscrolledPosition(wxPoint(0, 0))), false);
+        RefreshRect(hud_rect, false);
+    });
+}
+
+static wxString format_hit_rate(uint64_t hits, uint64_t misses) {
+    if (hits + misses == 0) return "-";
+    return wxString::Format("%d%% (%llu/%llu)", int(hits * 100 / (hits + misses)),
+        (unsigned long long) hits, (unsigned long long) (hits + misses));
+}
+
+static wxString format_megabytes(int64_t bytes) {
+    return wxString::Format("%.1f MB", std::max<int64_t>(bytes, 0) / (1024.0 * 1024.0));
+}
+
+// drawn at the top left corner of the window, whatever the scroll position
+void box_editor_panel::renderHud(wxDC &dc) {
+    wxRect hud_rect(CalcUnscrolledPosition(wxPoint(HUD_MARGIN, HUD_MARGIN)), hud_size);
+
+    // the paints that only refresh the overlay are not frames of the drag
+    auto now = std::chrono::steady_clock::now();
+    if (mouseIsDown && !hud_rect.Contains(m_dirty_rect)) {
+        drag_paints.push_back(now);
+        while (now - drag_paints.front() > std::chrono::seconds(1)) {
+            drag_paints.pop_front();
+        }
+        drag_fps = int(drag_paints.size());
+    } else if (!mouseIsDown) {
+        drag_paints.clear();
+    }
+
+    const auto &counters = perf_counters::get();
+    auto ms = [](int64_t us) {
+        return wxString::Format("%.1f ms", us / 1000.0);
+    };
+    std::vector<wxString> lines {
+        wxintl::translate("HUD_RENDER_TIME") + ms(counters.last_render_us),
+        wxintl::translate("HUD_SCALE_TIME") + ms(counters.last_scale_us),
+        wxintl::translate("HUD_PAINT_TIME") + ms(counters.last_paint_us),
+        wxintl::translate("HUD_DRAG_FPS") + (drag_fps ? wxString::Format("%d", drag_fps) : wxString("-")),
+        wxintl::translate("HUD_PAGE_CACHE") + format_hit_rate(counters.page_cache_hits, counters.page_cache_misses),
+        wxintl::translate("HUD_DISK_CACHE") + format_hit_rate(counters.render_cache_hits, counters.render_cache_misses),
+    };
+    for (int i = 0; i < MEMORY_SUBSYSTEM_COUNT; ++i) {
+        auto subsystem = static_cast<memory_subsystem>(i);
+        lines.push_back(wxintl::translate(memory_subsystem_label(subsystem)) + format_megabytes(memory_usage(subsystem)));
+    }
+    wxString total = wxintl::translate("MEMORY_TOTAL") + format_megabytes(memory_usage_total());
+    if (app->getMemoryBudget() > 0) {
+        total += " / " + format_megabytes(app->getMemoryBudget());
+    }
+    lines.push_back(total);
+
+    dc.SetFont(*wxSMALL_FONT);
+    int line_height = dc.GetCharHeight();
+    wxSize size(0, line_height * int(lines.size()));
+    for (const wxString &line : lines) {
+        size.x = std::max(size.x, dc.GetTextExtent(line).x);
+    }
+    size.IncBy(2 * HUD_PADDING);
+
+    // the timer refreshes the largest area the overlay has covered
+    hud_size.IncTo(size);
+    hud_rect.SetSize(size);
+
+    dc.SetPen(*wxBLACK_PEN);
+    dc.SetBrush(*wxWHITE_BRUSH);
+    dc.DrawRectangle(hud_rect);
+    dc.SetTextForeground(*wxBLACK);
+    for (size_t i = 0; i < lines.size(); ++i) {
+        dc.DrawText(lines[i], hud_rect.x + HUD_PADDING, hud_rect.y + HUD_PADDING + int(i) * line_height);
+    }
+}
+
+void box_editor_panel::setHeatmapVisible(bool visible) {
+    heatmap_visible = visible;
+    Refresh();
+}
+
+void box_editor_panel::updateHeatmap() {
+    heat_by_box.clear();
+    heat_generation = -1;
+
+    const box_profile &profile = app->getBoxProfile();
+    if (profile.empty() || profile.layout_generation != app->getLayoutGeneration()) {
+        Refresh();
+        return;
+    }
+
+    // the entries are in layout order
+    auto entry = profile.entries.begin();
+    size_t index = 0;
+    for (const layout_box &box : app->layout) {
+        if (entry == profile.entries.end()) break;
+        if (entry->index == index++) {
+            heat_by_box[&box] = profile.max_extract_us > 0 ? float(entry->extract_us) / profile.max_extract_us : 0.f;
+            ++entry;
+        }
+    }
+    heat_generation = profile.layout_generation;
+    Refresh();
+}
+
+// from yellow for the fastest boxes to red for the slowest
+static wxColour heat_colour(float heat, unsigned char alpha) {
+    return wxColour(255, (unsigned char) (220 * (1.f - heat)), 0, alpha);
+}
+
+void box_editor_panel::renderHeatmap(wxDC &dc, const std::vector<layout_box *> &visible) {
+    std::unique_ptr<wxGraphicsContext> gc;
+    if (auto *mem_dc = dynamic_cast<wxMemoryDC *>(&dc)) {
+        gc.reset(wxGraphicsContext::Create(*mem_dc));
+    }
+    dc.SetPen(*wxTRANSPARENT_PEN);
+    for (layout_box *box : visible) {
+        auto it = heat_by_box.find(box);
+        if (it == heat_by_box.end()) continue;
+
+        pdf_rect rect = *box;
+        clamp_rect(rect);
+        wxRect r(int(rect.x * scaled_width()), int(rect.y * scaled_height()), int(rect.w * scaled_width()), int(rect.h * scaled_height()));
+        if (gc) {
+            gc->SetBrush(wxBrush(heat_colour(it->second, (unsigned char) (60 + 120 * it->second))));
+            gc->DrawRectangle(r.x, r.y, r.width, r.height);
+        } else {
+            // without alpha, a hatch keeps the page readable under the box
+            dc.SetBrush(wxBrush(heat_colour(it->second, wxALPHA_OPAQUE), wxBRUSHSTYLE_CROSSDIAG_HATCH));
+            dc.DrawRectangle(r);
+        }
+    }
+    dc.SetBrush(*wxTRANSPARENT_BRUSH);
 }
 
 template<typename T>
@@ -80,13 +293,42 @@ auto find_iterator(const std::list<T> &list, const T *ptr) {
     return std::ranges::find(list, ptr, [](const T &obj) { return &obj; });
 };
 
+wxRect box_editor_panel::getBoxScreenRect(const pdf_rect &box) {
+    wxRect rect(
+        wxPoint(box.x * scaled_width(), box.y * scaled_height()),
+        wxSize(box.w * scaled_width(), box.h * scaled_height())
+    );
+    rect.SetPosition(CalcScrolledPosition(rect.GetPosition()));
+    return rect.Inflate(2);
+}
+
+std::vector<layout_box *> box_editor_panel::getBoxesIn(float x0, float y0, float x1, float y1) {
+    if (m_index_generation != app->getLayoutGeneration()) {
+        m_index.build(app->layout);
+        m_index_generation = app->getLayoutGeneration();
+    }
+    std::vector<layout_box *> ret;
+    m_index.query(app->getSelectedPage(), x0, y0, x1, y1, ret);
+
+    // selected boxes can be dragged or nudged away from their indexed cells before the layout is updated
+    for (layout_box *box : app->getSelection()) {
+        if (box->page == app->getSelectedPage() && std::ranges::find(ret, box) == ret.end()
+            && std::max(box->x, box->x + box->w) >= x0 && std::min(box->x, box->x + box->w) <= x1
+            && std::max(box->y, box->y + box->h) >= y0 && std::min(box->y, box->y + box->h) <= y1)
+        {
+            ret.push_back(box);
+        }
+    }
+    return ret;
+}
+
 layout_box *box_editor_panel::getBoxAt(float x, float y) {
     auto check_box = [&](const layout_box &box) {
         return (x > box.x && x < box.x + box.w && y > box.y && y < box.y + box.h && box.page == app->getSelectedPage());
     };
     if (selected_box && check_box(*selected_box)) return selected_box;
-    for (auto &box : app->layout) {
-        if (check_box(box)) return &box;
+    for (layout_box *box : getBoxesIn(x, y, x, y)) {
+        if (check_box(*box)) return box;
     }
     return nullptr;
 };
@@ -120,25 +362,115 @@ resize_node box_editor_panel::getBoxResizeNode(float x, float y) {
     if (selected_box) {
         if (auto node = check_box(*selected_box); bool(node)) return {selected_box, node};
     }
-    for (auto &box : app->layout) {
-        if (auto node = check_box(box); bool(node)) return {&box, node};
+    for (layout_box *box : getBoxesIn(x - nw, y - nh, x + nw, y + nh)) {
+        if (auto node = check_box(*box); bool(node)) return {box, node};
     }
     return {};
 };
 
+constexpr int SNAP_TOLERANCE = 6;
+
+std::optional<double> box_editor_panel::snapX(double x) {
+    if (m_ink.empty()) return std::nullopt;
+    int snapped = m_ink.snap_x(x * m_ink.width(), SNAP_TOLERANCE * m_ink.width() / scaled_width());
+    if (snapped < 0) return std::nullopt;
+    return double(snapped) / m_ink.width();
+}
+
+std::optional<double> box_editor_panel::snapY(double y) {
+    if (m_ink.empty()) return std::nullopt;
+    int snapped = m_ink.snap_y(y * m_ink.height(), SNAP_TOLERANCE * m_ink.height() / scaled_height());
+    if (snapped < 0) return std::nullopt;
+    return double(snapped) / m_ink.height();
+}
+
+wxRealPoint box_editor_panel::snapPoint(const wxRealPoint &pt) {
+    return wxRealPoint(snapX(pt.x).value_or(pt.x), snapY(pt.y).value_or(pt.y));
+}
+
+// moves a segment so that whichever of its ends is nearer to an ink edge lies on it
+template<typename T, typename Snap>
+static void snap_segment(T &pos, T size, Snap snap) {
+    auto start = snap(pos);
+    auto end = snap(pos + size);
+    if (start && (!end || std::abs(*start - pos) <= std::abs(*end - size - pos))) {
+        pos = *start;
+    } else if (end) {
+        pos = *end - size;
+    }
+}
+
+void box_editor_panel::beginDrag() {
+    drag_origins.clear();
+    for (layout_box *box : app->getSelectedBoxes()) {
+        drag_origins.emplace_back(box, *box);
+    }
+}
+
+std::vector<pdf_rect> box_editor_panel::suggestBoxes() {
+    std::vector<pdf_rect> ret;
+    const int min_gap = std::max(4, m_ink.width() / 80);
+    const int min_size = std::max(2, m_ink.width() / 200);
+    for (const ink_block &block : m_ink.suggest_blocks(min_gap, min_size)) {
+        pdf_rect &rect = ret.emplace_back();
+        rect.x = float(block.x) / m_ink.width();
+        rect.y = float(block.y) / m_ink.height();
+        rect.w = float(block.w) / m_ink.width();
+        rect.h = float(block.h) / m_ink.height();
+        rect.page = app->getSelectedPage();
+    }
+    return ret;
+}
+
+void box_editor_panel::recordMouseEvent(input_event_type type, const wxMouseEvent &evt) {
+    if (!input_recorder::get().recording()) return;
+    auto [xx, yy] = CalcUnscrolledPosition(evt.GetPosition());
+    input_recorder::get().record(type, 0, float(xx / scaled_width()), float(yy / scaled_height()), evt.GetModifiers());
+}
+
+void box_editor_panel::replayMouseEvent(const input_event &event) {
+    wxMouseEvent evt(event.type == input_event_type::mouse_down ? wxEVT_LEFT_DOWN
+        : event.type == input_event_type::mouse_up ? wxEVT_LEFT_UP : wxEVT_MOTION);
+    evt.SetEventObject(this);
+    evt.SetId(GetId());
+    evt.SetPosition(CalcScrolledPosition(wxPoint(int(event.x * scaled_width()), int(event.y * scaled_height()))));
+    evt.SetShiftDown(event.modifiers & wxMOD_SHIFT);
+    evt.SetControlDown(event.modifiers & wxMOD_CONTROL);
+    evt.SetAltDown(event.modifiers & wxMOD_ALT);
+    evt.SetLeftDown(event.type == input_event_type::mouse_down || (event.type == input_event_type::mouse_move && mouseIsDown));
+    HandleWindowEvent(evt);
+}
+
 void box_editor_panel::OnMouseDown(wxMouseEvent &evt) {
+    recordMouseEvent(input_event_type::mouse_down, evt);
+    commitNudge();
     start_pt = screen_to_layout(evt.GetPosition());
-    if (raw_image.IsOk() && !mouseIsDown) {
+    if (raw_image && !mouseIsDown) {
         switch (selected_tool) {
         case TOOL_SELECT: {
             layout_box *box = getBoxAt(start_pt.x, start_pt.y);
-            if (box) {
-                app->selectBox(box);
+            bool extend = evt.ShiftDown() || evt.ControlDown();
+            if (box && extend) {
+                app->toggleBoxSelection(box);
+            } else if (box) {
+                // dragging a selected box moves the whole selection
+                if (app->isBoxSelected(box)) {
+                    app->selectBoxes(app->getSelectedBoxes(), box);
+                } else {
+                    app->selectBox(box);
+                }
+                beginDrag();
                 dragging_offset.x = selected_box->x - start_pt.x;
                 dragging_offset.y = selected_box->y - start_pt.y;
+                rubber_band = false;
                 mouseIsDown = true;
             } else {
-                app->selectBox(nullptr);
+                if (!extend) {
+                    app->selectBox(nullptr);
+                }
+                end_pt = start_pt;
+                rubber_band = true;
+                mouseIsDown = true;
             }
             break;
         }
@@ -148,16 +480,22 @@ void box_editor_panel::OnMouseDown(wxMouseEvent &evt) {
             break;
         case TOOL_DELETEBOX: {
             auto *box = getBoxAt(start_pt.x, start_pt.y);
-            if (box && box_dialog::closeDialog(*box)) {
-                app->layout.erase(find_iterator(app->layout, box));
-                app->updateLayout();
-                Refresh();
+            if (box && app->isBoxSelected(box)) {
+                app->deleteBoxes(app->getSelectedBoxes());
+            } else if (box) {
+                app->deleteBoxes({box});
             }
             break;
         }
         case TOOL_RESIZE: {
             if (auto node = getBoxResizeNode(start_pt.x, start_pt.y)) {
-                app->selectBox(node.box);
+                // the same edges of every selected box follow the dragged one
+                if (app->isBoxSelected(node.box)) {
+                    app->selectBoxes(app->getSelectedBoxes(), node.box);
+                } else {
+                    app->selectBox(node.box);
+                }
+                beginDrag();
                 node_directions = node.directions;
                 mouseIsDown = true;
             } else {
@@ -168,8 +506,10 @@ void box_editor_panel::OnMouseDown(wxMouseEvent &evt) {
         case TOOL_MOVEPAGE: {
             layout_box *box = getBoxAt(start_pt.x, start_pt.y);
             if (box) {
-                app->selectBox(box);
-                MovePageDialog(app, box).ShowModal();
+                if (!app->isBoxSelected(box)) {
+                    app->selectBox(box);
+                }
+                MovePageDialog(app, app->getSelectedBoxes()).ShowModal();
             } else {
                 app->selectBox(nullptr);
             }
@@ -181,6 +521,7 @@ void box_editor_panel::OnMouseDown(wxMouseEvent &evt) {
 }
 
 void box_editor_panel::OnMouseUp(wxMouseEvent &evt) {
+    recordMouseEvent(input_event_type::mouse_up, evt);
     if (mouseIsDown) {
         mouseIsDown = false;
 
@@ -188,13 +529,35 @@ void box_editor_panel::OnMouseUp(wxMouseEvent &evt) {
         if (end_pt != start_pt) {
             switch (selected_tool) {
             case TOOL_SELECT:
-                if (selected_box && start_pt != end_pt) {
-                    clamp_rect(*selected_box);
+                if (rubber_band) {
+                    pdf_rect band;
+                    band.x = std::min(start_pt.x, end_pt.x);
+                    band.y = std::min(start_pt.y, end_pt.y);
+                    band.w = std::abs(start_pt.x - end_pt.x);
+                    band.h = std::abs(start_pt.y - end_pt.y);
+
+                    auto selected = app->getSelectedBoxes();
+                    for (auto &box : app->layout) {
+                        if (box.page == app->getSelectedPage() && !app->isBoxSelected(&box)
+                            && box.x >= band.x && box.y >= band.y
+                            && box.x + box.w <= band.x + band.w && box.y + box.h <= band.y + band.h)
+                        {
+                            selected.push_back(&box);
+                        }
+                    }
+                    app->selectBoxes(selected, selected_box);
+                } else if (!drag_origins.empty()) {
+                    for (auto &[box, origin] : drag_origins) {
+                        clamp_rect(*box);
+                    }
                     app->updateLayout();
-                    app->selectBox(selected_box);
                 }
                 break;
             case TOOL_NEWBOX: {
+                if (!evt.AltDown()) {
+                    start_pt = snapPoint(start_pt);
+                    end_pt = snapPoint(end_pt);
+                }
                 auto &box = *app->layout.emplace(selected_box ? find_iterator(app->layout, selected_box) : app->layout.end());
                 box.x = std::min(start_pt.x, end_pt.x);
                 box.y = std::min(start_pt.y, end_pt.y);
@@ -229,25 +592,26 @@ void box_editor_panel::OnMouseUp(wxMouseEvent &evt) {
             case TOOL_DELETEBOX:
                 break;
             case TOOL_RESIZE:
-                if (selected_box) {
-                    if (start_pt != end_pt) {
-                        if (selected_box->w < 0) {
-                            selected_box->w = -selected_box->w;
-                            selected_box->x -= selected_box->w;
+                if (!drag_origins.empty()) {
+                    for (auto &[box, origin] : drag_origins) {
+                        if (box->w < 0) {
+                            box->w = -box->w;
+                            box->x -= box->w;
                         }
-                        if (selected_box->h < 0) {
-                            selected_box->h = -selected_box->h;
-                            selected_box->y -= selected_box->h;
+                        if (box->h < 0) {
+                            box->h = -box->h;
+                            box->y -= box->h;
                         }
-                        app->updateLayout();
-                        app->selectBox(selected_box);
                     }
+                    app->updateLayout();
                 }
                 OnMouseMove(evt); // changes cursor
                 break;
             }
         }
 
+        rubber_band = false;
+        drag_origins.clear();
         Refresh();
     }
     evt.Skip();
@@ -265,29 +629,64 @@ void box_editor_panel::OnDoubleClick(wxMouseEvent &evt) {
 }
 
 void box_editor_panel::OnMouseMove(wxMouseEvent &evt) {
+    recordMouseEvent(input_event_type::mouse_move, evt);
     end_pt = screen_to_layout(evt.GetPosition());
 
     if (mouseIsDown) {
         switch (selected_tool) {
         case TOOL_SELECT:
-            selected_box->x = dragging_offset.x + end_pt.x;
-            selected_box->y = dragging_offset.y + end_pt.y;
+            if (!rubber_band && selected_box) {
+                // the focused box is snapped, the rest of the selection follows it
+                pdf_rect moved = *selected_box;
+                moved.x = dragging_offset.x + end_pt.x;
+                moved.y = dragging_offset.y + end_pt.y;
+                if (!evt.AltDown()) {
+                    snap_segment(moved.x, moved.w, [&](double x) { return snapX(x); });
+                    snap_segment(moved.y, moved.h, [&](double y) { return snapY(y); });
+                }
+                auto it = std::ranges::find(drag_origins, selected_box, [](const auto &pair) { return pair.first; });
+                if (it != drag_origins.end()) {
+                    float dx = moved.x - it->second.x;
+                    float dy = moved.y - it->second.y;
+                    for (auto &[box, origin] : drag_origins) {
+                        box->x = origin.x + dx;
+                        box->y = origin.y + dy;
+                    }
+                }
+            }
             break;
         case TOOL_RESIZE: {
+            if (!evt.AltDown()) {
+                end_pt = snapPoint(end_pt);
+            }
+            auto it = std::ranges::find(drag_origins, selected_box, [](const auto &pair) { return pair.first; });
+            if (it == drag_origins.end()) break;
+
+            const pdf_rect &focus = it->second;
+            float d_left = 0.f, d_top = 0.f, d_right = 0.f, d_bottom = 0.f;
             if (bool(node_directions & direction::TOP)) {
-                selected_box->h = selected_box->y + selected_box->h - end_pt.y;
-                selected_box->y = end_pt.y;
+                d_top = end_pt.y - focus.y;
             } else if (bool(node_directions & direction::BOTTOM)) {
-                selected_box->h = end_pt.y - selected_box->y;
+                d_bottom = end_pt.y - (focus.y + focus.h);
             }
             if (bool(node_directions & direction::LEFT)) {
-                selected_box->w = selected_box->x + selected_box->w - end_pt.x;
-                selected_box->x = end_pt.x;
+                d_left = end_pt.x - focus.x;
             } else if (bool(node_directions & direction::RIGHT)) {
-                selected_box->w = end_pt.x - selected_box->x;
+                d_right = end_pt.x - (focus.x + focus.w);
+            }
+            for (auto &[box, origin] : drag_origins) {
+                box->x = origin.x + d_left;
+                box->y = origin.y + d_top;
+                box->w = origin.w + d_right - d_left;
+                box->h = origin.h + d_bottom - d_top;
             }
             break;
         }
+        case TOOL_NEWBOX:
+            if (!evt.AltDown()) {
+                end_pt = snapPoint(end_pt);
+            }
+            break;
         default:
             break;
         }
@@ -325,25 +724,45 @@ void box_editor_panel::OnMouseMove(wxMouseEvent &evt) {
 
 void box_editor_panel::OnKeyDown(wxKeyEvent &evt) {
     constexpr float MOVE_AMT = 5.f;
-    if (selected_box) {
-        switch (evt.GetKeyCode()) {
-            case WXK_LEFT: selected_box->x -= MOVE_AMT / scaled_width(); Refresh(); break;
-            case WXK_RIGHT: selected_box->x += MOVE_AMT / scaled_width(); Refresh(); break;
-            case WXK_UP: selected_box->y -= MOVE_AMT / scaled_height(); Refresh(); break;
-            case WXK_DOWN: selected_box->y += MOVE_AMT / scaled_height(); Refresh(); break;
-        }
+    float dx = 0.f, dy = 0.f;
+    switch (evt.GetKeyCode()) {
+        case WXK_LEFT: dx = -MOVE_AMT / scaled_width(); break;
+        case WXK_RIGHT: dx = MOVE_AMT / scaled_width(); break;
+        case WXK_UP: dy = -MOVE_AMT / scaled_height(); break;
+        case WXK_DOWN: dy = MOVE_AMT / scaled_height(); break;
+        default: return;
+    }
+    auto selected = app->getSelectedBoxes();
+    if (selected.empty()) return;
+
+    // auto repeat only repaints the boxes that moved, the layout is updated once the keys are released
+    for (layout_box *box : selected) {
+        wxRect dirty = getBoxScreenRect(*box);
+        box->x += dx;
+        box->y += dy;
+        RefreshRect(dirty.Union(getBoxScreenRect(*box)), false);
     }
+    nudge_pending = true;
+    nudge_timer.StartOnce(NUDGE_COMMIT_DELAY);
 }
 
 void box_editor_panel::OnKeyUp(wxKeyEvent &evt) {
-    if (selected_box) {
-        switch (evt.GetKeyCode()) {
-        case WXK_LEFT:
-        case WXK_RIGHT:
-        case WXK_UP:
-        case WXK_DOWN:
-            app->updateLayout();
-            app->selectBox(selected_box);
-        }
+    if (nudge_pending) {
+        nudge_timer.StartOnce(NUDGE_COMMIT_DELAY);
+    }
+}
+
+void box_editor_panel::OnNudgeTimer(wxTimerEvent &evt) {
+    commitNudge();
+}
+
+void box_editor_panel::commitNudge() {
+    if (nudge_pending) {
+        app->updateLayout();
     }
+}
+
+void box_editor_panel::clearNudge() {
+    nudge_pending = false;
+    nudge_timer.Stop();
 }
\ No newline at end of file
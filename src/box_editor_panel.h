@@ -4,6 +4,16 @@
 #include "image_panel.h"
 #include "editor.h"
 #include "text_dialog.h"
+#include "box_index.h"
+#include "input_session.h"
+
+#include <wx/timer.h>
+
+#include <chrono>
+#include <deque>
+#include <optional>
+#include <unordered_map>
+#include <vector>
 
 using namespace bls;
 
@@ -39,6 +49,26 @@ public:
         selected_box = box;
     }
 
+    std::vector<pdf_rect> suggestBoxes();
+
+    // commits keyboard nudges that are still waiting for the idle timer
+    void commitNudge();
+
+    // forgets the pending nudges, called by updateLayout which records the moved boxes itself
+    void clearNudge();
+
+    // sends a recorded mouse event through the event table, at the same page position
+    void replayMouseEvent(const input_event &event);
+
+    // overlay with the timings, cache hit rates and memory counters of the editor
+    void setHudVisible(bool visible);
+
+    // tints the boxes of the page by their text extraction time in the last profiled read
+    void setHeatmapVisible(bool visible);
+
+    // picks up the profile of the frame after a read
+    void updateHeatmap();
+
 protected:
     void render(wxDC &dc) override;
 
@@ -48,6 +78,9 @@ protected:
     void OnMouseMove(wxMouseEvent &evt);
     void OnKeyDown(wxKeyEvent &evt);
     void OnKeyUp(wxKeyEvent &evt);
+    void OnNudgeTimer(wxTimerEvent &evt);
+    void OnHudTimer(wxTimerEvent &evt);
+    void OnScrollWin(wxScrollWinEvent &evt);
 
 private:
     wxRealPoint screen_to_layout(const wxPoint &pt) {
@@ -58,9 +91,27 @@ private:
         );
     }
 
+    // the area of the window covered by a box and its outline
+    wxRect getBoxScreenRect(const pdf_rect &box);
+
+    // boxes of the selected page overlapping a rectangle in page coordinates, in layout order
+    std::vector<layout_box *> getBoxesIn(float x0, float y0, float x1, float y1);
+
     layout_box *getBoxAt(float x, float y);
     resize_node getBoxResizeNode(float x, float y);
 
+    void recordMouseEvent(input_event_type type, const wxMouseEvent &evt);
+
+    void renderHud(wxDC &dc);
+    void renderHeatmap(wxDC &dc, const std::vector<layout_box *> &visible);
+
+    // remembers where the selected boxes were when a group move or resize started
+    void beginDrag();
+
+    std::optional<double> snapX(double x);
+    std::optional<double> snapY(double y);
+    wxRealPoint snapPoint(const wxRealPoint &pt);
+
 private:
     class frame_editor *app;
 
@@ -70,6 +121,29 @@ private:
     layout_box *selected_box = nullptr;
     direction node_directions{};
     bool mouseIsDown = false;
+    bool rubber_band = false;
+
+    std::vector<std::pair<layout_box *, pdf_rect>> drag_origins;
+
+    box_index m_index;
+    int m_index_generation = -1;
+
+    wxTimer nudge_timer;
+    bool nudge_pending = false;
+
+    wxTimer hud_timer;
+    bool hud_visible = false;
+    wxSize hud_size;
+
+    bool heatmap_visible = false;
+
+    // share of the slowest extraction time of each profiled box, for the layout generation of the profile
+    std::unordered_map<const layout_box *, float> heat_by_box;
+    int heat_generation = -1;
+
+    // paints of the last second of the current drag, to show its frame rate
+    std::deque<std::chrono::steady_clock::time_point> drag_paints;
+    int drag_fps = 0;
 
     int selected_tool = TOOL_SELECT;
 
@@ -0,0 +1,70 @@
+#include "box_index.h"
+
+#include <algorithm>
+
+int box_index::cell_coord(float value) {
+    return std::clamp(int(value * GRID_SIZE), 0, GRID_SIZE - 1);
+}
+
+void box_index::clear() {
+    m_boxes.clear();
+    m_pages.clear();
+    m_marks.clear();
+    m_query = 0;
+}
+
+void box_index::build(layout_box_list &layout) {
+    clear();
+    for (auto &box : layout) {
+        uint32_t id = uint32_t(m_boxes.size());
+        m_boxes.push_back(&box);
+
+        auto &cells = m_pages[box.page];
+        if (cells.empty()) {
+            cells.resize(GRID_SIZE * GRID_SIZE);
+        }
+        int cx0 = cell_coord(std::min(box.x, box.x + box.w));
+        int cx1 = cell_coord(std::max(box.x, box.x + box.w));
+        int cy0 = cell_coord(std::min(box.y, box.y + box.h));
+        int cy1 = cell_coord(std::max(box.y, box.y + box.h));
+        for (int cy = cy0; cy <= cy1; ++cy) {
+            for (int cx = cx0; cx <= cx1; ++cx) {
+                cells[cy * GRID_SIZE + cx].push_back(id);
+            }
+        }
+    }
+    m_marks.assign(m_boxes.size(), 0);
+}
+
+void box_index::query(int page, float x0, float y0, float x1, float y1, std::vector<layout_box *> &out) const {
+    auto it = m_pages.find(page);
+    if (it == m_pages.end()) return;
+
+    // boxes spanning several cells are only reported once
+    if (++m_query == 0) {
+        std::ranges::fill(m_marks, 0);
+        m_query = 1;
+    }
+
+    std::vector<uint32_t> ids;
+    const auto &cells = it->second;
+    for (int cy = cell_coord(y0); cy <= cell_coord(y1); ++cy) {
+        for (int cx = cell_coord(x0); cx <= cell_coord(x1); ++cx) {
+            for (uint32_t id : cells[cy * GRID_SIZE + cx]) {
+                if (m_marks[id] == m_query) continue;
+                m_marks[id] = m_query;
+
+                const layout_box &box = *m_boxes[id];
+                if (std::max(box.x, box.x + box.w) >= x0 && std::min(box.x, box.x + box.w) <= x1
+                    && std::max(box.y, box.y + box.h) >= y0 && std::min(box.y, box.y + box.h) <= y1)
+                {
+                    ids.push_back(id);
+                }
+            }
+        }
+    }
+    std::ranges::sort(ids);
+    for (uint32_t id : ids) {
+        out.push_back(m_boxes[id]);
+    }
+}
\ No newline at end of file
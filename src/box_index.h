@@ -0,0 +1,36 @@
+#ifndef __BOX_INDEX_H__
+#define __BOX_INDEX_H__
+
+#include <vector>
+#include <unordered_map>
+#include <cstdint>
+
+#include "layout.h"
+
+using namespace bls;
+
+// Uniform grid over the page coordinates of the boxes of each page.
+// Rebuilt from scratch when the layout changes, which is cheap compared to
+// scanning every box of the layout on each repaint or mouse move.
+class box_index {
+public:
+    void build(layout_box_list &layout);
+    void clear();
+
+    // appends the boxes of page that overlap the rectangle, in layout order
+    void query(int page, float x0, float y0, float x1, float y1, std::vector<layout_box *> &out) const;
+
+private:
+    static constexpr int GRID_SIZE = 32;
+
+    static int cell_coord(float value);
+
+private:
+    std::vector<layout_box *> m_boxes;
+    std::unordered_map<int, std::vector<std::vector<uint32_t>>> m_pages;
+
+    mutable std::vector<uint32_t> m_marks;
+    mutable uint32_t m_query = 0;
+};
+
+#endif
\ No newline at end of file
@@ -0,0 +1,38 @@
+#include "box_profile.h"
+
+#include <algorithm>
+#include <chrono>
+
+#include "trace.h"
+
+box_profile profile_boxes(const pdf_document &doc, const layout_box_list &layout, const std::atomic<bool> &abort) {
+    TRACE_SCOPE("profile_boxes");
+
+    box_profile ret;
+    int num_pages = doc.num_pages();
+    size_t index = 0;
+    for (const layout_box &box : layout) {
+        if (abort.load(std::memory_order_relaxed)) break;
+
+        size_t box_index = index++;
+        if (box.page <= 0 || box.page > num_pages || box.w <= 0.f || box.h <= 0.f) continue;
+
+        auto &entry = ret.entries.emplace_back();
+        entry.index = box_index;
+        entry.name = box.name;
+        entry.page = box.page;
+        entry.mode = box.mode;
+        if (!box.script.empty()) {
+            entry.script_lines = int(std::ranges::count(box.script, '\n')) + 1;
+        }
+        entry.goto_label = box.goto_label;
+
+        auto start = std::chrono::steady_clock::now();
+        std::string text = doc.get_text(box);
+        entry.extract_us = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+        entry.text_bytes = text.size();
+
+        ret.max_extract_us = std::max(ret.max_extract_us, entry.extract_us);
+    }
+    return ret;
+}
\ No newline at end of file
@@ -0,0 +1,45 @@
+#ifndef __BOX_PROFILE_H__
+#define __BOX_PROFILE_H__
+
+#include <atomic>
+#include <string>
+#include <vector>
+#include <cstdint>
+
+#include "layout.h"
+#include "pdf_document.h"
+
+using namespace bls;
+
+// Cost of a box of the layout during a read.
+// The reader runs the whole layout at once, so the time spent in the scripts of a box
+// can't be told apart from the rest: the profile times the text extraction of each box
+// on its page, and lists the size of the script and the goto label of the box next to it.
+struct box_profile_entry {
+    size_t index = 0;           // position of the box in the layout
+    std::string name;
+    int page = 0;
+    read_mode mode{};
+    int64_t extract_us = 0;
+    size_t text_bytes = 0;
+    int script_lines = 0;
+    std::string goto_label;
+};
+
+struct box_profile {
+    // layout generation the indices refer to
+    int layout_generation = -1;
+    int64_t read_us = 0;
+    int64_t max_extract_us = 0;
+    std::vector<box_profile_entry> entries;
+
+    bool empty() const {
+        return entries.empty();
+    }
+};
+
+// extracts the text of every box of the layout that lies on a page of the document,
+// stops early and returns the boxes profiled so far when abort is set
+box_profile profile_boxes(const pdf_document &doc, const layout_box_list &layout, const std::atomic<bool> &abort);
+
+#endif
\ No newline at end of file
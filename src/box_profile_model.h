@@ -0,0 +1,87 @@
+#ifndef __BOX_PROFILE_MODEL_H__
+#define __BOX_PROFILE_MODEL_H__
+
+#include <wx/dataview.h>
+
+#include "box_profile.h"
+#include "wxintl.h"
+
+enum {
+    PROFILE_COL_NAME,
+    PROFILE_COL_PAGE,
+    PROFILE_COL_MODE,
+    PROFILE_COL_EXTRACT,
+    PROFILE_COL_TEXT,
+    PROFILE_COL_SCRIPT,
+    PROFILE_COL_GOTO,
+    PROFILE_COL_COUNT
+};
+
+// One row per profiled box. Shown as text, sorted by the numbers behind it.
+class BoxProfileModel : public wxDataViewIndexListModel {
+private:
+    std::vector<box_profile_entry> m_entries;
+
+public:
+    void SetEntries(std::vector<box_profile_entry> entries) {
+        m_entries = std::move(entries);
+        Reset(m_entries.size());
+    }
+
+    const box_profile_entry *GetEntry(const wxDataViewItem &item) const {
+        if (!item.IsOk()) return nullptr;
+        return &m_entries[GetRow(item)];
+    }
+
+    virtual unsigned int GetColumnCount() const override {
+        return PROFILE_COL_COUNT;
+    }
+
+    virtual wxString GetColumnType(unsigned int col) const override {
+        return "string";
+    }
+
+    virtual void GetValueByRow(wxVariant &variant, unsigned int row, unsigned int col) const override {
+        const box_profile_entry &entry = m_entries[row];
+        switch (col) {
+        case PROFILE_COL_NAME:      variant = wxintl::to_wx(entry.name); break;
+        case PROFILE_COL_PAGE:      variant = wxString::Format("%d", entry.page); break;
+        case PROFILE_COL_MODE:      variant = wxintl::enum_label(entry.mode); break;
+        case PROFILE_COL_EXTRACT:   variant = wxString::Format("%.2f", entry.extract_us / 1000.0); break;
+        case PROFILE_COL_TEXT:      variant = wxString::Format("%zu", entry.text_bytes); break;
+        case PROFILE_COL_SCRIPT:    variant = entry.script_lines ? wxString::Format("%d", entry.script_lines) : wxString(); break;
+        case PROFILE_COL_GOTO:      variant = wxintl::to_wx(entry.goto_label); break;
+        }
+    }
+
+    virtual bool SetValueByRow(const wxVariant &, unsigned int, unsigned int) override {
+        return false;
+    }
+
+    virtual bool HasDefaultCompare() const override {
+        return true;
+    }
+
+    virtual int Compare(const wxDataViewItem &item1, const wxDataViewItem &item2, unsigned int column, bool ascending) const override {
+        const box_profile_entry &a = m_entries[GetRow(item1)];
+        const box_profile_entry &b = m_entries[GetRow(item2)];
+        auto cmp = [](const auto &x, const auto &y) {
+            return x < y ? -1 : y < x ? 1 : 0;
+        };
+        int ret = 0;
+        switch (column) {
+        case PROFILE_COL_NAME:      ret = cmp(a.name, b.name); break;
+        case PROFILE_COL_PAGE:      ret = cmp(a.page, b.page); break;
+        case PROFILE_COL_MODE:      ret = cmp(static_cast<int>(a.mode), static_cast<int>(b.mode)); break;
+        case PROFILE_COL_EXTRACT:   ret = cmp(a.extract_us, b.extract_us); break;
+        case PROFILE_COL_TEXT:      ret = cmp(a.text_bytes, b.text_bytes); break;
+        case PROFILE_COL_SCRIPT:    ret = cmp(a.script_lines, b.script_lines); break;
+        case PROFILE_COL_GOTO:      ret = cmp(a.goto_label, b.goto_label); break;
+        }
+        // the default order, and ties, follow the layout
+        if (ret == 0) ret = cmp(a.index, b.index);
+        return ascending ? ret : -ret;
+    }
+};
+
+#endif
\ No newline at end of file
@@ -0,0 +1,76 @@
+#include "buffer_pool.h"
+
+#include <bit>
+#include <cstdlib>
+
+constexpr size_t MIN_POOLED_SIZE = 64 * 1024;
+constexpr size_t MAX_BUFFERS_PER_BUCKET = 4;
+constexpr size_t MAX_POOLED_BYTES = 256 * 1024 * 1024;
+
+buffer_pool &buffer_pool::get() {
+    static buffer_pool pool;
+    return pool;
+}
+
+buffer_pool::~buffer_pool() {
+    trim();
+}
+
+size_t buffer_pool::bucket_above(size_t size) {
+    if (size <= MIN_POOLED_SIZE) return MIN_POOLED_SIZE;
+    size_t step = std::bit_floor(size) / 4;
+    return (size + step - 1) / step * step;
+}
+
+size_t buffer_pool::bucket_below(size_t size) {
+    if (size <= MIN_POOLED_SIZE) return MIN_POOLED_SIZE;
+    size_t step = std::bit_floor(size) / 4;
+    return size / step * step;
+}
+
+uint8_t *buffer_pool::acquire(size_t size, size_t &capacity) {
+    capacity = bucket_above(size);
+    {
+        std::scoped_lock lock(m_mutex);
+        auto it = m_buckets.find(capacity);
+        if (it != m_buckets.end() && !it->second.empty()) {
+            uint8_t *data = it->second.back();
+            it->second.pop_back();
+            m_pooled -= capacity;
+            return data;
+        }
+    }
+    return static_cast<uint8_t *>(malloc(capacity));
+}
+
+void buffer_pool::release(uint8_t *data, size_t capacity) {
+    if (!data) return;
+    if (capacity >= MIN_POOLED_SIZE) {
+        // buffers adopted from elsewhere may not be bucket sized, they are filed one bucket lower
+        size_t bucket = bucket_below(capacity);
+        std::scoped_lock lock(m_mutex);
+        auto &buffers = m_buckets[bucket];
+        if (buffers.size() < MAX_BUFFERS_PER_BUCKET && m_pooled + bucket <= MAX_POOLED_BYTES) {
+            buffers.push_back(data);
+            m_pooled += bucket;
+            return;
+        }
+    }
+    free(data);
+}
+
+void buffer_pool::trim() {
+    std::scoped_lock lock(m_mutex);
+    for (auto &[size, buffers] : m_buckets) {
+        for (uint8_t *data : buffers) {
+            free(data);
+        }
+    }
+    m_buckets.clear();
+    m_pooled = 0;
+}
+
+size_t buffer_pool::bytes_pooled() const {
+    std::scoped_lock lock(m_mutex);
+    return m_pooled;
+}
\ No newline at end of file
@@ -0,0 +1,41 @@
+#ifndef __BUFFER_POOL_H__
+#define __BUFFER_POOL_H__
+
+#include <cstdint>
+#include <cstddef>
+#include <mutex>
+#include <map>
+#include <vector>
+
+// Size-bucketed pool of page sized buffers, shared by the renderer and the image panels.
+// Buffers are allocated with malloc so that the ones released by pdf_image can be recycled too.
+class buffer_pool {
+public:
+    static buffer_pool &get();
+
+    ~buffer_pool();
+
+    // returns a buffer of at least size bytes, capacity receives its real size
+    uint8_t *acquire(size_t size, size_t &capacity);
+
+    // gives back a buffer of the given capacity, it is freed if the pool is full
+    void release(uint8_t *data, size_t capacity);
+
+    void trim();
+
+    size_t bytes_pooled() const;
+
+private:
+    buffer_pool() = default;
+
+    // buckets are spaced four per power of two, so that at most a fifth of a buffer is wasted
+    static size_t bucket_above(size_t size);
+    static size_t bucket_below(size_t size);
+
+private:
+    mutable std::mutex m_mutex;
+    std::map<size_t, std::vector<uint8_t *>> m_buckets;
+    size_t m_pooled = 0;
+};
+
+#endif
\ No newline at end of file
@@ -1,89 +1,163 @@
 #include "clipboard.h"
 #include <wx/clipbrd.h>
 
+#include <format>
+#include <cmath>
+#include <climits>
+#include <limits>
+
+#include "layout_serial.h"
+#include "json_utils.h"
+
+constexpr uint32_t CLIPBOARD_MAGIC = 0x42534c42; // "BLSB"
+constexpr uint64_t CLIPBOARD_VERSION = 1;
+
 class BoxDataObject : public wxCustomDataObject {
 public:
-    BoxDataObject() : wxCustomDataObject("layout_box") {}
+    BoxDataObject() : wxCustomDataObject("layout_boxes") {}
     
-    BoxDataObject(const layout_box &box);
+    BoxDataObject(const std::vector<layout_box> &boxes);
 
-    layout_box GetLayoutBox() const;
+    std::vector<layout_box> GetLayoutBoxes() const;
 };
 
-BoxDataObject::BoxDataObject(const layout_box &box) : BoxDataObject() {
-    wxMemoryBuffer buffer;
-
-    auto add_data = [&](const auto &data) { buffer.AppendData(&data, sizeof(data)); };
-    auto add_string = [&](const std::string &data) { add_data(data.size()); buffer.AppendData(data.data(), data.size()); };
-
-    add_data(box.x);
-    add_data(box.y);
-    add_data(box.w);
-    add_data(box.h);
-    add_data(box.page);
-    add_data(box.mode);
-    add_data(box.flags);
-    add_string(box.name);
-    add_string(box.script);
-    add_string(box.spacers);
-    add_string(box.goto_label);
-    
-    SetData(buffer.GetDataLen(), buffer.GetData());
+BoxDataObject::BoxDataObject(const std::vector<layout_box> &boxes) : BoxDataObject() {
+    binary_writer writer;
+    writer.write_bytes(&CLIPBOARD_MAGIC, sizeof(CLIPBOARD_MAGIC));
+    writer.write_varint(CLIPBOARD_VERSION);
+    writer.write_varint(boxes.size());
+    for (const layout_box &box : boxes) {
+        writer.write_box(box);
+    }
+    SetData(writer.data().size(), writer.data().data());
 }
 
-layout_box BoxDataObject::GetLayoutBox() const {
-    layout_box box;
-
-    char *ptr = (char *) GetData();
-    size_t datalen = GetDataSize();
-    size_t offset = 0;
-
-    auto get_data = [&](auto &data) {
-        if (offset + sizeof(data) > datalen) throw std::out_of_range("Invalid data");
-        memcpy(&data, ptr + offset, sizeof(data));
-        offset += sizeof(data);
-    };
-    auto get_string = [&](std::string &data) {
-        size_t len;
-        get_data(len);
-        if (offset + len > datalen) throw std::out_of_range("Invalid data");
-        data.resize(len);
-        memcpy(data.data(), ptr + offset, len);
-        offset += len;
-    };
-
-    get_data(box.x);
-    get_data(box.y);
-    get_data(box.w);
-    get_data(box.h);
-    get_data(box.page);
-    get_data(box.mode);
-    get_data(box.flags);
-    get_string(box.name);
-    get_string(box.script);
-    get_string(box.spacers);
-    get_string(box.goto_label);
-
-    return box;
+std::vector<layout_box> BoxDataObject::GetLayoutBoxes() const {
+    binary_reader reader(std::string_view(static_cast<const char *>(GetData()), GetDataSize()));
+
+    uint32_t magic;
+    reader.read_bytes(&magic, sizeof(magic));
+    if (magic != CLIPBOARD_MAGIC || reader.read_varint() != CLIPBOARD_VERSION) {
+        throw std::out_of_range("Invalid data");
+    }
+
+    // every box takes more than one byte, a larger count can only come from corrupt data
+    uint64_t count = reader.read_varint();
+    if (count > GetDataSize() - reader.offset()) {
+        throw std::out_of_range("Invalid data");
+    }
+
+    std::vector<layout_box> boxes;
+    boxes.reserve(count);
+    for (uint64_t i = 0; i < count; ++i) {
+        boxes.push_back(reader.read_box());
+    }
+    return boxes;
+}
+
+// JSON has no NaN or infinity, such coordinates are written as 0
+static float finite_or_zero(float value) {
+    return std::isfinite(value) ? value : 0.f;
 }
 
-bool SetClipboard(const layout_box &box) {
+std::string BoxesToJson(const std::vector<layout_box> &boxes) {
+    std::string out = std::format("{{\"layout_boxes\":{},\"boxes\":[", CLIPBOARD_VERSION);
+    for (const layout_box &box : boxes) {
+        if (&box != &boxes.front()) out += ',';
+        out += std::format("\n{{\"x\":{},\"y\":{},\"w\":{},\"h\":{},\"page\":{},\"mode\":{},\"flags\":{}",
+            finite_or_zero(box.x), finite_or_zero(box.y), finite_or_zero(box.w), finite_or_zero(box.h), box.page, static_cast<int>(box.mode), get_flags_mask(box));
+        auto add_string = [&](std::string_view key, const std::string &value) {
+            out += std::format(",\"{}\":", key);
+            append_json_string(out, value);
+        };
+        add_string("name", box.name);
+        add_string("script", box.script);
+        add_string("spacers", box.spacers);
+        add_string("goto_label", box.goto_label);
+        out += '}';
+    }
+    out += "\n]}\n";
+    return out;
+}
+
+// numbers that do not fit in an unsigned integer are rejected before the conversion
+static uint64_t to_unsigned(double number) {
+    if (!(number >= 0 && number < 0x1p64) || number != std::floor(number)) {
+        throw std::out_of_range("Invalid data");
+    }
+    return uint64_t(number);
+}
+
+static int to_int(double number) {
+    if (!(number >= INT_MIN && number <= INT_MAX) || number != std::floor(number)) {
+        throw std::out_of_range("Invalid data");
+    }
+    return int(number);
+}
+
+static float to_float(double number) {
+    if (!std::isfinite(number) || std::abs(number) > std::numeric_limits<float>::max()) {
+        throw std::out_of_range("Invalid data");
+    }
+    return float(number);
+}
+
+std::vector<layout_box> BoxesFromJson(std::string_view str) {
+    json_value doc = json_value::parse(str);
+    if (!doc.contains("layout_boxes") || doc["layout_boxes"].as_number() != CLIPBOARD_VERSION) {
+        throw std::out_of_range("Invalid data");
+    }
+
+    std::vector<layout_box> boxes;
+    for (const json_value &value : doc["boxes"].as_array()) {
+        layout_box &box = boxes.emplace_back();
+        box.x = to_float(value["x"].as_number());
+        box.y = to_float(value["y"].as_number());
+        box.w = to_float(value["w"].as_number());
+        box.h = to_float(value["h"].as_number());
+        box.page = to_int(value["page"].as_number());
+        set_read_mode(box, to_unsigned(value["mode"].as_number()));
+        set_flags_mask(box, to_unsigned(value["flags"].as_number()));
+
+        // missing strings are allowed, so that boxes can be written by hand
+        auto get_string = [&](std::string_view key, std::string &out) {
+            if (value.contains(key)) out = value[key].as_string();
+        };
+        get_string("name", box.name);
+        get_string("script", box.script);
+        get_string("spacers", box.spacers);
+        get_string("goto_label", box.goto_label);
+    }
+    return boxes;
+}
+
+bool SetClipboard(const std::vector<layout_box> &boxes) {
     if (wxTheClipboard->Open()) {
-        wxTheClipboard->SetData(new BoxDataObject(box));
+        auto *data = new wxDataObjectComposite;
+        data->Add(new BoxDataObject(boxes), true);
+        data->Add(new wxTextDataObject(wxString::FromUTF8(BoxesToJson(boxes))));
+        wxTheClipboard->SetData(data);
         wxTheClipboard->Close();
         return true;
     }
     return false;
 }
 
-bool GetClipboard(layout_box &box) {
+bool GetClipboard(std::vector<layout_box> &boxes) {
+    bool ret = false;
     if (wxTheClipboard->Open()) {
-        if (BoxDataObject clip_data; wxTheClipboard->GetData(clip_data)) {
-            box = clip_data.GetLayoutBox();
-            wxTheClipboard->Close();
-            return true;
+        try {
+            if (BoxDataObject clip_data; wxTheClipboard->IsSupported(clip_data.GetFormat()) && wxTheClipboard->GetData(clip_data)) {
+                boxes = clip_data.GetLayoutBoxes();
+                ret = true;
+            } else if (wxTextDataObject text_data; wxTheClipboard->IsSupported(wxDF_UNICODETEXT) && wxTheClipboard->GetData(text_data)) {
+                boxes = BoxesFromJson(text_data.GetText().utf8_str().data());
+                ret = true;
+            }
+        } catch (const std::exception &) {
+            // text that is not a list of boxes is not pasted
         }
+        wxTheClipboard->Close();
     }
-    wxTheClipboard->Close();
-    return false;
+    return ret;
 }
\ No newline at end of file
@@ -1,6 +1,14 @@
+#include <vector>
+#include <string>
+#include <string_view>
+
 #include "layout.h"
 
 using namespace bls;
 
-bool SetClipboard(const layout_box &box);
-bool GetClipboard(layout_box &box);
\ No newline at end of file
+bool SetClipboard(const std::vector<layout_box> &boxes);
+bool GetClipboard(std::vector<layout_box> &boxes);
+
+// the text flavour of the clipboard, a JSON document that scripts can read and write
+std::string BoxesToJson(const std::vector<layout_box> &boxes);
+std::vector<layout_box> BoxesFromJson(std::string_view str);
\ No newline at end of file
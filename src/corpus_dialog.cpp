@@ -0,0 +1,236 @@
+#include "corpus_dialog.h"
+
+#include <wx/sizer.h>
+#include <wx/msgdlg.h>
+
+#include <numeric>
+
+enum {
+    CTL_RESULTS = 10000,
+    CTL_RUN,
+    CTL_ACCEPT,
+    CTL_ACCEPT_ALL,
+};
+
+BEGIN_EVENT_TABLE(corpus_dialog, wxDialog)
+    EVT_BUTTON(CTL_RUN, corpus_dialog::OnRun)
+    EVT_BUTTON(CTL_ACCEPT, corpus_dialog::OnAccept)
+    EVT_BUTTON(CTL_ACCEPT_ALL, corpus_dialog::OnAcceptAll)
+    EVT_DATAVIEW_SELECTION_CHANGED(CTL_RESULTS, corpus_dialog::OnSelectionChanged)
+    EVT_CLOSE(corpus_dialog::OnClose)
+END_EVENT_TABLE()
+
+static const char *status_label(corpus_status status) {
+    switch (status) {
+    case corpus_status::matched:    return "CORPUS_MATCHED";
+    case corpus_status::unchanged:  return "CORPUS_UNCHANGED";
+    case corpus_status::changed:    return "CORPUS_CHANGED";
+    case corpus_status::no_golden:  return "CORPUS_NO_GOLDEN";
+    case corpus_status::failed:     return "CORPUS_FAILED";
+    }
+    return "";
+}
+
+corpus_dialog::corpus_dialog(frame_editor *parent, const wxString &folder) :
+    wxDialog(parent, wxID_ANY, wxintl::translate("CORPUS_DIALOG_TITLE"), wxDefaultPosition, wxDefaultSize, wxDEFAULT_DIALOG_STYLE | wxRESIZE_BORDER),
+    parent(parent), m_store(folder.ToStdString()), m_runner(this)
+{
+    wxBoxSizer *sizer = new wxBoxSizer(wxVERTICAL);
+
+    m_summary = new wxStaticText(this, wxID_ANY, wxEmptyString);
+    sizer->Add(m_summary, wxSizerFlags().Expand().Border(wxALL, 5));
+
+    m_list = new wxDataViewListCtrl(this, CTL_RESULTS, wxDefaultPosition, wxSize(600, 350), wxDV_MULTIPLE | wxDV_ROW_LINES);
+    const int flags = wxDATAVIEW_COL_SORTABLE | wxDATAVIEW_COL_RESIZABLE;
+    m_list->AppendTextColumn(wxintl::translate("CORPUS_FILE"), wxDATAVIEW_CELL_INERT, 280, wxALIGN_LEFT, flags);
+    m_list->AppendTextColumn(wxintl::translate("CORPUS_STATUS"), wxDATAVIEW_CELL_INERT, 120, wxALIGN_LEFT, flags);
+    m_list->AppendColumn(new wxDataViewColumn(wxintl::translate("CORPUS_READ_MS"), new wxDataViewTextRenderer("long"), 2, 90, wxALIGN_RIGHT, flags));
+    m_list->AppendColumn(new wxDataViewColumn(wxintl::translate("CORPUS_DIFFERENCES"), new wxDataViewTextRenderer("long"), 3, 90, wxALIGN_RIGHT, flags));
+    sizer->Add(m_list, wxSizerFlags(2).Expand().Border(wxLEFT | wxRIGHT, 5));
+
+    m_details = new wxTextCtrl(this, wxID_ANY, wxEmptyString, wxDefaultPosition, wxSize(600, 150), wxTE_MULTILINE | wxTE_READONLY | wxTE_DONTWRAP);
+    sizer->Add(m_details, wxSizerFlags(1).Expand().Border(wxALL, 5));
+
+    wxBoxSizer *buttons = new wxBoxSizer(wxHORIZONTAL);
+    m_run_button = new wxButton(this, CTL_RUN, wxintl::translate("CORPUS_ABORT"));
+    m_accept_button = new wxButton(this, CTL_ACCEPT, wxintl::translate("CORPUS_ACCEPT_SELECTED"));
+    m_accept_all_button = new wxButton(this, CTL_ACCEPT_ALL, wxintl::translate("CORPUS_ACCEPT_ALL"));
+    buttons->Add(m_run_button, wxSizerFlags().Border(wxALL, 5));
+    buttons->Add(m_accept_button, wxSizerFlags().Border(wxALL, 5));
+    buttons->Add(m_accept_all_button, wxSizerFlags().Border(wxALL, 5));
+    buttons->AddStretchSpacer();
+    buttons->Add(new wxButton(this, wxID_CANCEL, wxintl::translate("Close")), wxSizerFlags().Border(wxALL, 5));
+    sizer->Add(buttons, wxSizerFlags().Expand());
+
+    SetSizerAndFit(sizer);
+
+    Bind(wxEVT_COMMAND_CORPUS_RESULT, &corpus_dialog::OnResult, this);
+    Bind(wxEVT_COMMAND_CORPUS_DONE, &corpus_dialog::OnDone, this);
+
+    startRun();
+}
+
+void corpus_dialog::startRun() {
+    m_results.clear();
+    m_list->DeleteAllItems();
+    m_details->Clear();
+
+    m_layout_hash = hash_layout(parent->layout);
+    m_run_start = std::chrono::steady_clock::now();
+    m_run_us = 0;
+    m_total = m_runner.start(m_store, parent->layout);
+
+    updateSummary();
+    updateButtons();
+}
+
+void corpus_dialog::updateSummary() {
+    size_t counts[5] = {};
+    int64_t read_us = 0;
+    for (const corpus_result &result : m_results) {
+        ++counts[static_cast<int>(result.status)];
+        read_us += result.read_us;
+    }
+    m_summary->SetLabel(wxintl::translate("CORPUS_SUMMARY", m_results.size(), m_total,
+        counts[static_cast<int>(corpus_status::matched)] + counts[static_cast<int>(corpus_status::unchanged)],
+        counts[static_cast<int>(corpus_status::changed)],
+        counts[static_cast<int>(corpus_status::no_golden)],
+        counts[static_cast<int>(corpus_status::failed)],
+        read_us / 1000, m_run_us / 1000));
+}
+
+void corpus_dialog::updateButtons() {
+    bool running = m_runner.running();
+    m_run_button->SetLabel(wxintl::translate(running ? "CORPUS_ABORT" : "CORPUS_RUN_AGAIN"));
+    m_accept_button->Enable(!running);
+    m_accept_all_button->Enable(!running);
+}
+
+void corpus_dialog::OnResult(wxThreadEvent &evt) {
+    size_t index = m_results.size();
+    const corpus_result &result = m_results.emplace_back(evt.GetPayload<corpus_result>());
+
+    wxVector<wxVariant> values;
+    values.push_back(wxintl::to_wx(result.name));
+    values.push_back(wxintl::translate(status_label(result.status)));
+    values.push_back(long(result.read_us / 1000));
+    values.push_back(long(result.diffs.size()));
+    m_list->AppendItem(values, index);
+
+    updateSummary();
+}
+
+// the store is only written once the threads stopped reading it
+void corpus_dialog::OnDone(wxThreadEvent &evt) {
+    m_runner.close();
+    m_run_us = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - m_run_start).count();
+
+    m_store.set_layout(m_layout_hash);
+    for (const corpus_result &result : m_results) {
+        if (result.status == corpus_status::matched || result.status == corpus_status::unchanged) {
+            m_store.set_validated(result.name, result.pdf_hash);
+        } else {
+            m_store.clear_validated(result.name);
+        }
+    }
+    saveValidated();
+
+    updateSummary();
+    updateButtons();
+}
+
+void corpus_dialog::saveValidated() {
+    try {
+        m_store.save_validated();
+    } catch (const std::exception &error) {
+        wxMessageBox(error.what(), wxintl::translate("PROGRAM_NAME"), wxICON_ERROR);
+    }
+}
+
+void corpus_dialog::OnRun(wxCommandEvent &evt) {
+    if (m_runner.running()) {
+        m_runner.abort();
+    } else {
+        startRun();
+    }
+}
+
+void corpus_dialog::acceptResults(const std::vector<size_t> &indices) {
+    if (m_runner.running()) {
+        wxBell();
+        return;
+    }
+    try {
+        for (size_t index : indices) {
+            corpus_result &result = m_results[index];
+            if (result.status != corpus_status::changed && result.status != corpus_status::no_golden) continue;
+
+            m_store.save_golden(result.name, result.pdf_hash, result.output);
+            m_store.set_validated(result.name, result.pdf_hash);
+            result.status = corpus_status::matched;
+            result.diffs.clear();
+        }
+    } catch (const std::exception &error) {
+        wxMessageBox(error.what(), wxintl::translate("PROGRAM_NAME"), wxICON_ERROR);
+    }
+    saveValidated();
+
+    for (unsigned int row = 0; row < unsigned(m_list->GetItemCount()); ++row) {
+        const corpus_result &result = m_results[m_list->GetItemData(m_list->RowToItem(row))];
+        m_list->SetTextValue(wxintl::translate(status_label(result.status)), row, 1);
+        m_list->SetValue(long(result.diffs.size()), row, 3);
+    }
+    updateSummary();
+}
+
+void corpus_dialog::OnAccept(wxCommandEvent &evt) {
+    wxDataViewItemArray items;
+    m_list->GetSelections(items);
+    std::vector<size_t> indices;
+    for (const auto &item : items) {
+        indices.push_back(m_list->GetItemData(item));
+    }
+    acceptResults(indices);
+}
+
+void corpus_dialog::OnAcceptAll(wxCommandEvent &evt) {
+    if (wxMessageBox(wxintl::translate("CORPUS_ACCEPT_ALL_CONFIRM"), wxintl::translate("PROGRAM_NAME"), wxYES_NO | wxICON_WARNING) != wxYES) {
+        return;
+    }
+    std::vector<size_t> indices(m_results.size());
+    std::iota(indices.begin(), indices.end(), 0);
+    acceptResults(indices);
+}
+
+void corpus_dialog::OnSelectionChanged(wxDataViewEvent &evt) {
+    if (!evt.GetItem().IsOk()) {
+        m_details->Clear();
+        return;
+    }
+    const corpus_result &result = m_results[m_list->GetItemData(evt.GetItem())];
+
+    wxString text;
+    if (result.status == corpus_status::failed) {
+        text = wxintl::to_wx(result.error);
+    }
+    for (const output_difference &diff : result.diffs) {
+        switch (diff.kind) {
+        case output_diff_kind::changed:
+            text += wxintl::translate("CORPUS_DIFF_CHANGED", diff.table + 1, diff.key, diff.expected, diff.actual);
+            break;
+        case output_diff_kind::missing:
+            text += wxintl::translate("CORPUS_DIFF_MISSING", diff.table + 1, diff.key, diff.expected);
+            break;
+        case output_diff_kind::added:
+            text += wxintl::translate("CORPUS_DIFF_ADDED", diff.table + 1, diff.key, diff.actual);
+            break;
+        }
+        text += '\n';
+    }
+    m_details->ChangeValue(text);
+}
+
+void corpus_dialog::OnClose(wxCloseEvent &evt) {
+    m_runner.close();
+    evt.Skip();
+}
\ No newline at end of file
@@ -0,0 +1,58 @@
+#ifndef __CORPUS_DIALOG_H__
+#define __CORPUS_DIALOG_H__
+
+#include <wx/dialog.h>
+#include <wx/dataview.h>
+#include <wx/stattext.h>
+#include <wx/textctrl.h>
+#include <wx/button.h>
+
+#include <chrono>
+#include <vector>
+
+#include "editor.h"
+#include "corpus_runner.h"
+
+// Runs the layout of the editor against a folder of PDFs and compares the results
+// to the golden outputs of the folder, which can be replaced by the new results.
+class corpus_dialog : public wxDialog {
+public:
+    corpus_dialog(frame_editor *parent, const wxString &folder);
+
+private:
+    frame_editor *parent;
+
+    corpus_store m_store;
+    corpus_runner m_runner;
+    uint64_t m_layout_hash = 0;
+
+    std::vector<corpus_result> m_results;
+    size_t m_total = 0;
+    std::chrono::steady_clock::time_point m_run_start;
+    int64_t m_run_us = 0;
+
+    wxStaticText *m_summary;
+    wxDataViewListCtrl *m_list;
+    wxTextCtrl *m_details;
+    wxButton *m_run_button;
+    wxButton *m_accept_button;
+    wxButton *m_accept_all_button;
+
+    void startRun();
+    void updateSummary();
+    void updateButtons();
+    void acceptResults(const std::vector<size_t> &indices);
+    void saveValidated();
+
+    void OnRun(wxCommandEvent &evt);
+    void OnAccept(wxCommandEvent &evt);
+    void OnAcceptAll(wxCommandEvent &evt);
+    void OnSelectionChanged(wxDataViewEvent &evt);
+    void OnResult(wxThreadEvent &evt);
+    void OnDone(wxThreadEvent &evt);
+    void OnClose(wxCloseEvent &evt);
+
+    DECLARE_EVENT_TABLE()
+};
+
+#endif
\ No newline at end of file
@@ -0,0 +1,152 @@
+#include "corpus_golden.h"
+
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+
+#include "file_hash.h"
+#include "file_utils.h"
+#include "json_utils.h"
+
+static const flat_table empty_table;
+
+std::vector<output_difference> diff_outputs(const flat_output &expected, const flat_output &actual) {
+    std::vector<output_difference> ret;
+    for (size_t i = 0; i < std::max(expected.size(), actual.size()); ++i) {
+        const flat_table &exp = i < expected.size() ? expected[i] : empty_table;
+        const flat_table &act = i < actual.size() ? actual[i] : empty_table;
+
+        // both tables are sorted by key, walk them side by side
+        auto e = exp.begin();
+        auto a = act.begin();
+        while (e != exp.end() || a != act.end()) {
+            if (a == act.end() || (e != exp.end() && e->first < a->first)) {
+                ret.push_back({output_diff_kind::missing, i, e->first, e->second, {}});
+                ++e;
+            } else if (e == exp.end() || a->first < e->first) {
+                ret.push_back({output_diff_kind::added, i, a->first, {}, a->second});
+                ++a;
+            } else {
+                if (e->second != a->second) {
+                    ret.push_back({output_diff_kind::changed, i, e->first, e->second, a->second});
+                }
+                ++e;
+                ++a;
+            }
+        }
+    }
+    return ret;
+}
+
+static std::string read_file(const std::filesystem::path &filename) {
+    std::ifstream stream(filename, std::ios::binary);
+    if (!stream) return {};
+    std::ostringstream ss;
+    ss << stream.rdbuf();
+    return ss.str();
+}
+
+corpus_store::corpus_store(const std::filesystem::path &folder) : m_folder(folder) {
+    try {
+        std::string data = read_file(m_folder / ".golden" / "validated.json");
+        if (data.empty()) return;
+
+        json_value obj = json_value::parse(data);
+        m_layout_hash = std::stoull(obj["layout"].as_string(), nullptr, 16);
+        for (const auto &[name, hash] : obj["files"].as_object()) {
+            m_validated.emplace(name, std::stoull(hash.as_string(), nullptr, 16));
+        }
+    } catch (const std::exception &) {
+        // a damaged record only means every PDF is read again
+        m_layout_hash = 0;
+        m_validated.clear();
+    }
+}
+
+std::filesystem::path corpus_store::golden_filename(const std::string &name) const {
+    return m_folder / ".golden" / std::filesystem::path(name + ".json");
+}
+
+std::optional<flat_output> corpus_store::load_golden(const std::string &name, uint64_t pdf_hash) const {
+    std::string data = read_file(golden_filename(name));
+    if (data.empty()) return std::nullopt;
+
+    try {
+        json_value obj = json_value::parse(data);
+        if (obj["pdf_hash"].as_string() != hash_to_hex(pdf_hash)) {
+            return std::nullopt;
+        }
+        flat_output ret;
+        for (const json_value &table : obj["tables"].as_array()) {
+            flat_table &out = ret.emplace_back();
+            for (const auto &[key, value] : table.as_object()) {
+                out.emplace(key, value.as_string());
+            }
+        }
+        return ret;
+    } catch (const std::exception &) {
+        return std::nullopt;
+    }
+}
+
+void corpus_store::save_golden(const std::string &name, uint64_t pdf_hash, const flat_output &output) {
+    std::string out = "{\"pdf_hash\":\"" + hash_to_hex(pdf_hash) + "\",\"tables\":[";
+    for (size_t i = 0; i < output.size(); ++i) {
+        if (i != 0) out += ',';
+        out += "\n{";
+        bool first = true;
+        for (const auto &[key, value] : output[i]) {
+            if (!first) out += ',';
+            first = false;
+            out += "\n";
+            append_json_string(out, key);
+            out += ':';
+            append_json_string(out, value);
+        }
+        out += '}';
+    }
+    out += "]}\n";
+
+    std::filesystem::path filename = golden_filename(name);
+    std::error_code ec;
+    std::filesystem::create_directories(filename.parent_path(), ec);
+    atomic_write_file(filename, out);
+}
+
+bool corpus_store::is_validated(const std::string &name, uint64_t pdf_hash, uint64_t layout_hash) const {
+    if (layout_hash != m_layout_hash) return false;
+    auto it = m_validated.find(name);
+    return it != m_validated.end() && it->second == pdf_hash;
+}
+
+void corpus_store::set_layout(uint64_t layout_hash) {
+    if (layout_hash != m_layout_hash) {
+        m_layout_hash = layout_hash;
+        m_validated.clear();
+    }
+}
+
+void corpus_store::set_validated(const std::string &name, uint64_t pdf_hash) {
+    m_validated[name] = pdf_hash;
+}
+
+void corpus_store::clear_validated(const std::string &name) {
+    m_validated.erase(name);
+}
+
+void corpus_store::save_validated() {
+    std::string out = "{\"layout\":\"" + hash_to_hex(m_layout_hash) + "\",\"files\":{";
+    bool first = true;
+    for (const auto &[name, hash] : m_validated) {
+        if (!first) out += ',';
+        first = false;
+        out += "\n";
+        append_json_string(out, name);
+        out += ":\"" + hash_to_hex(hash) + "\"";
+    }
+    out += "}}\n";
+
+    std::error_code ec;
+    std::filesystem::create_directories(m_folder / ".golden", ec);
+    atomic_write_file(m_folder / ".golden" / "validated.json", out);
+}
\ No newline at end of file
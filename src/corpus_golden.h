@@ -0,0 +1,70 @@
+#ifndef __CORPUS_GOLDEN_H__
+#define __CORPUS_GOLDEN_H__
+
+#include <filesystem>
+#include <map>
+#include <optional>
+#include <string>
+#include <vector>
+#include <cstdint>
+
+// The values of a read as plain strings, one map per table.
+// Array elements are keyed as name[i], so that outputs compare key by key.
+using flat_table = std::map<std::string, std::string, std::less<>>;
+using flat_output = std::vector<flat_table>;
+
+enum class output_diff_kind {
+    changed,
+    missing,    // in the golden output only
+    added,      // in the new output only
+};
+
+struct output_difference {
+    output_diff_kind kind;
+    size_t table;
+    std::string key;
+    std::string expected;
+    std::string actual;
+};
+
+std::vector<output_difference> diff_outputs(const flat_output &expected, const flat_output &actual);
+
+// Golden outputs of a folder of PDFs, kept in its .golden subfolder next to the record
+// of which PDFs last matched them, and with which layout.
+// A PDF is named by its path relative to the folder.
+class corpus_store {
+public:
+    explicit corpus_store(const std::filesystem::path &folder);
+
+    const std::filesystem::path &folder() const {
+        return m_folder;
+    }
+
+    // nullopt if there is no golden output for the PDF, or it was stored for different file contents.
+    // Safe to call from several threads.
+    std::optional<flat_output> load_golden(const std::string &name, uint64_t pdf_hash) const;
+
+    // throws std::runtime_error if the file can't be written
+    void save_golden(const std::string &name, uint64_t pdf_hash, const flat_output &output);
+
+    // true if the PDF matched its golden output the last time it was read with this layout
+    bool is_validated(const std::string &name, uint64_t pdf_hash, uint64_t layout_hash) const;
+
+    // forgets the validated PDFs if the layout changed
+    void set_layout(uint64_t layout_hash);
+    void set_validated(const std::string &name, uint64_t pdf_hash);
+    void clear_validated(const std::string &name);
+
+    // throws std::runtime_error if the file can't be written
+    void save_validated();
+
+private:
+    std::filesystem::path golden_filename(const std::string &name) const;
+
+private:
+    std::filesystem::path m_folder;
+    uint64_t m_layout_hash = 0;
+    std::map<std::string, uint64_t> m_validated;
+};
+
+#endif
\ No newline at end of file
@@ -0,0 +1,203 @@
+#include "corpus_runner.h"
+
+#include <wx/filefn.h>
+
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <format>
+
+#include "pdf_document.h"
+#include "file_hash.h"
+#include "layout_serial.h"
+#include "trace.h"
+
+wxDEFINE_EVENT(wxEVT_COMMAND_CORPUS_RESULT, wxThreadEvent);
+wxDEFINE_EVENT(wxEVT_COMMAND_CORPUS_DONE, wxThreadEvent);
+
+static void flatten_variable(flat_table &out, const std::string &key, const variable &var) {
+    if (var.is_array()) {
+        const auto &arr = var.as_array();
+        for (size_t i = 0; i < arr.size(); ++i) {
+            flatten_variable(out, std::format("{}[{}]", key, i), arr[i]);
+        }
+    } else {
+        out.emplace(key, std::string(var.as_view()));
+    }
+}
+
+flat_table flatten_table(const variable_map &table) {
+    flat_table ret;
+    for (const auto &[key, val] : table) {
+        flatten_variable(ret, key, val);
+    }
+    return ret;
+}
+
+uint64_t hash_layout(const layout_box_list &layout) {
+    binary_writer writer;
+    writer.write_options(layout);
+    for (const layout_box &box : layout) {
+        writer.write_box(box);
+    }
+    return hash_string(writer.data());
+}
+
+std::vector<std::string> list_corpus(const std::filesystem::path &folder) {
+    std::vector<std::string> ret;
+    std::error_code ec;
+    for (auto it = std::filesystem::recursive_directory_iterator(folder, ec); !ec && it != std::filesystem::recursive_directory_iterator(); it.increment(ec)) {
+        if (it->is_directory() && it->path().filename() == ".golden") {
+            it.disable_recursion_pending();
+            continue;
+        }
+        std::string ext = it->path().extension().string();
+        std::ranges::transform(ext, ext.begin(), [](unsigned char c) { return std::tolower(c); });
+        if (it->is_regular_file() && ext == ".pdf") {
+            ret.push_back(std::filesystem::relative(it->path(), folder).generic_string());
+        }
+    }
+    std::ranges::sort(ret);
+    return ret;
+}
+
+corpus_thread::corpus_thread(wxEvtHandler *parent, std::shared_ptr<corpus_job> job)
+    : wxThread(wxTHREAD_JOINABLE), parent(parent), m_job(std::move(job)) {}
+
+wxThread::ExitCode corpus_thread::Entry() {
+    tracer::get().setThreadName("corpus");
+
+    reader my_reader;
+    {
+        std::scoped_lock lock(m_job->mutex);
+        m_job->readers.insert(&my_reader);
+    }
+
+    while (!m_job->aborted) {
+        size_t index = m_job->next_file++;
+        if (index >= m_job->files.size()) break;
+
+        corpus_result result = runFile(my_reader, m_job->files[index]);
+        if (m_job->aborted) break;
+
+        auto *evt = new wxThreadEvent(wxEVT_COMMAND_CORPUS_RESULT);
+        evt->SetPayload(std::move(result));
+        wxQueueEvent(parent, evt);
+    }
+
+    {
+        std::scoped_lock lock(m_job->mutex);
+        m_job->readers.erase(&my_reader);
+    }
+
+    // the last thread out reports the end of the run
+    if (--m_job->running_threads == 0) {
+        wxQueueEvent(parent, new wxThreadEvent(wxEVT_COMMAND_CORPUS_DONE));
+    }
+    return (wxThread::ExitCode) 0;
+}
+
+corpus_result corpus_thread::runFile(reader &my_reader, const std::string &name) {
+    TRACE_SCOPE("corpus_thread::runFile");
+
+    corpus_result result;
+    result.name = name;
+
+    std::filesystem::path filename = m_job->folder / std::filesystem::path(name);
+    try {
+        result.pdf_hash = hash_file(filename);
+    } catch (const std::exception &error) {
+        result.error = error.what();
+        return result;
+    }
+
+    // nothing changed since this file last matched its golden output
+    if (m_job->store->is_validated(name, result.pdf_hash, m_job->layout_hash)) {
+        result.status = corpus_status::unchanged;
+        return result;
+    }
+
+    try {
+        pdf_document doc;
+        doc.open(filename.string());
+
+        auto start = std::chrono::steady_clock::now();
+        my_reader.clear();
+        my_reader.set_document(doc);
+        my_reader.add_layout(m_job->layout);
+        my_reader.start();
+        result.read_us = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+
+        for (const variable_map &table : my_reader.get_values()) {
+            result.output.push_back(flatten_table(table));
+        }
+    } catch (const scripted_error &error) {
+        result.error = std::format("{} ({})", error.what(), error.errcode);
+        return result;
+    } catch (const std::exception &error) {
+        result.error = error.what();
+        return result;
+    } catch (reader_aborted) {
+        return result;
+    }
+
+    auto golden = m_job->store->load_golden(name, result.pdf_hash);
+    if (!golden) {
+        result.status = corpus_status::no_golden;
+    } else {
+        result.diffs = diff_outputs(*golden, result.output);
+        result.status = result.diffs.empty() ? corpus_status::matched : corpus_status::changed;
+    }
+    return result;
+}
+
+corpus_runner::~corpus_runner() {
+    close();
+}
+
+size_t corpus_runner::start(const corpus_store &store, const layout_box_list &layout) {
+    close();
+
+    m_job = std::make_shared<corpus_job>();
+    m_job->folder = store.folder();
+    m_job->files = list_corpus(store.folder());
+    m_job->layout = layout;
+    if (m_job->layout.filename.empty()) m_job->layout.filename = std::filesystem::path(wxGetCwd().ToStdString()) / "tmp.bls";
+    m_job->layout_hash = hash_layout(layout);
+    m_job->store = &store;
+
+    int num_threads = std::clamp(wxThread::GetCPUCount(), 1, int(std::max<size_t>(m_job->files.size(), 1)));
+    m_job->running_threads = num_threads;
+    for (int i = 0; i < num_threads; ++i) {
+        auto *thread = new corpus_thread(parent, m_job);
+        if (thread->Run() != wxTHREAD_NO_ERROR) {
+            delete thread;
+            if (--m_job->running_threads == 0) {
+                wxQueueEvent(parent, new wxThreadEvent(wxEVT_COMMAND_CORPUS_DONE));
+            }
+        } else {
+            m_threads.push_back(thread);
+        }
+    }
+    return m_job->files.size();
+}
+
+void corpus_runner::abort() {
+    if (!m_job) return;
+    m_job->aborted = true;
+
+    std::scoped_lock lock(m_job->mutex);
+    for (reader *r : m_job->readers) {
+        r->abort();
+    }
+}
+
+void corpus_runner::close() {
+    abort();
+    for (corpus_thread *thread : m_threads) {
+        thread->Wait();
+        delete thread;
+    }
+    m_threads.clear();
+    m_job.reset();
+}
\ No newline at end of file
@@ -0,0 +1,108 @@
+#ifndef __CORPUS_RUNNER_H__
+#define __CORPUS_RUNNER_H__
+
+#include <wx/thread.h>
+#include <wx/event.h>
+
+#include <atomic>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "layout.h"
+#include "reader.h"
+#include "corpus_golden.h"
+
+using namespace bls;
+
+wxDECLARE_EVENT(wxEVT_COMMAND_CORPUS_RESULT, wxThreadEvent);
+wxDECLARE_EVENT(wxEVT_COMMAND_CORPUS_DONE, wxThreadEvent);
+
+enum class corpus_status {
+    matched,
+    unchanged,  // matched with this layout and these contents before, not read again
+    changed,
+    no_golden,
+    failed,
+};
+
+struct corpus_result {
+    std::string name;
+    uint64_t pdf_hash = 0;
+    corpus_status status = corpus_status::failed;
+    int64_t read_us = 0;
+    std::string error;
+    flat_output output;
+    std::vector<output_difference> diffs;
+};
+
+flat_table flatten_table(const variable_map &table);
+
+// hash of the boxes and options of a layout, a validated PDF is read again when it changes
+uint64_t hash_layout(const layout_box_list &layout);
+
+// the PDFs of a folder and its subfolders, by path relative to the folder
+std::vector<std::string> list_corpus(const std::filesystem::path &folder);
+
+// Shared between the corpus threads: each thread takes the next PDF until none are left.
+struct corpus_job {
+    std::filesystem::path folder;
+    std::vector<std::string> files;
+    layout_box_list layout;
+    uint64_t layout_hash = 0;
+    const corpus_store *store = nullptr;
+
+    std::atomic<size_t> next_file = 0;
+    std::atomic<int> running_threads = 0;
+    std::atomic<bool> aborted = false;
+
+    // the readers in use, so that an abort can stop them in the middle of a file
+    std::mutex mutex;
+    std::set<reader *> readers;
+};
+
+class corpus_thread : public wxThread {
+public:
+    corpus_thread(wxEvtHandler *parent, std::shared_ptr<corpus_job> job);
+
+protected:
+    virtual ExitCode Entry() override;
+
+private:
+    corpus_result runFile(reader &my_reader, const std::string &name);
+
+private:
+    wxEvtHandler *parent;
+    std::shared_ptr<corpus_job> m_job;
+};
+
+// Reads every PDF of a folder with one layout, a thread per core.
+// Each file is reported with a wxEVT_COMMAND_CORPUS_RESULT event carrying a corpus_result,
+// then a wxEVT_COMMAND_CORPUS_DONE event follows the last one.
+class corpus_runner {
+public:
+    corpus_runner(wxEvtHandler *parent) : parent(parent) {}
+    ~corpus_runner();
+
+    // the store must stay unchanged until the run is done, returns the number of files
+    size_t start(const corpus_store &store, const layout_box_list &layout);
+    void abort();
+
+    // stops the threads and waits for them
+    void close();
+
+    bool running() const {
+        return m_job && m_job->running_threads > 0;
+    }
+
+private:
+    wxEvtHandler *parent;
+
+    std::shared_ptr<corpus_job> m_job;
+    std::vector<corpus_thread *> m_threads;
+};
+
+#endif
\ No newline at end of file
@@ -9,13 +9,23 @@
 
 #include "resources.h"
 #include "box_editor_panel.h"
+#include "thumbnail_panel.h"
 #include "box_dialog.h"
+#include "render_cache.h"
+#include "layout_cache.h"
+#include "layout_index.h"
+#include "file_hash.h"
+#include "trace.h"
+#include "perf_counters.h"
+#include "memory_budget.h"
+#include "output_dialog.h"
 
 enum {
     MENU_NEW = 10000, MENU_OPEN, MENU_SAVE, MENU_SAVEAS, MENU_CLOSE,
     MENU_UNDO, MENU_REDO, MENU_CUT, MENU_COPY, MENU_PASTE,
     MENU_LOAD_PDF, MENU_EDITBOX, MENU_DELETE, MENU_READDATA,
-    MENU_EDITCONTROL, MENU_OPEN_LAYOUT_OPTIONS,
+    MENU_EDITCONTROL, MENU_OPEN_LAYOUT_OPTIONS, MENU_SUGGEST_BOXES, MENU_VALIDATE_CORPUS, MENU_BUILD_LAYOUT_INDEX, MENU_GRAYSCALE,
+    MENU_CHANGE_MODE, MENU_CHANGE_PAGE, MENU_EXPORT_TRACE, MENU_PERF_HUD, MENU_BOX_HEATMAP,
 
     MENU_OPEN_RECENT,
     MENU_OPEN_RECENT_END = MENU_OPEN_RECENT + MAX_RECENT_FILES_HISTORY,
@@ -46,9 +56,18 @@ BEGIN_EVENT_TABLE(frame_editor, wxFrame)
     EVT_MENU_RANGE (MENU_OPEN_PDF_RECENT, MENU_OPEN_PDF_RECENT_END, frame_editor::OnOpenRecentPdf)
     EVT_MENU (MENU_EDITBOX, frame_editor::EditSelectedBox)
     EVT_MENU (MENU_DELETE, frame_editor::OnDelete)
+    EVT_MENU (MENU_CHANGE_MODE, frame_editor::OnChangeMode)
+    EVT_MENU (MENU_CHANGE_PAGE, frame_editor::OnChangePage)
     EVT_MENU (MENU_READDATA, frame_editor::OnReadData)
     EVT_MENU (MENU_EDITCONTROL, frame_editor::OpenControlScript)
     EVT_MENU (MENU_OPEN_LAYOUT_OPTIONS, frame_editor::OnOpenLayoutOptions)
+    EVT_MENU (MENU_SUGGEST_BOXES, frame_editor::OnSuggestBoxes)
+    EVT_MENU (MENU_VALIDATE_CORPUS, frame_editor::OnValidateCorpus)
+    EVT_MENU (MENU_BUILD_LAYOUT_INDEX, frame_editor::OnBuildLayoutIndex)
+    EVT_MENU (MENU_GRAYSCALE, frame_editor::OnToggleGrayscale)
+    EVT_MENU (MENU_EXPORT_TRACE, frame_editor::OnExportTrace)
+    EVT_MENU (MENU_PERF_HUD, frame_editor::OnTogglePerfHud)
+    EVT_MENU (MENU_BOX_HEATMAP, frame_editor::OnToggleHeatmap)
     EVT_TOOL (CTL_FIND_LAYOUT, frame_editor::OnFindLayout)
     EVT_TOOL (CTL_ROTATE, frame_editor::OnRotate)
     EVT_TOOL (CTL_LOAD_PDF, frame_editor::OnLoadPdf)
@@ -82,7 +101,10 @@ DECLARE_RESOURCE(tool_settings_png)
 
 constexpr size_t MAX_HISTORY_SIZE = 20;
 
-frame_editor::frame_editor() : wxFrame(nullptr, wxID_ANY, wxintl::translate("PROGRAM_NAME"), wxDefaultPosition, wxSize(900, 700)) {
+// undo steps that are kept whatever the memory budget
+constexpr ptrdiff_t MIN_UNDO_STEPS = 2;
+
+frame_editor::frame_editor() : wxFrame(nullptr, wxID_ANY, wxintl::translate("PROGRAM_NAME"), wxDefaultPosition, wxSize(900, 700)), m_saver(this), m_renderer(this) {
     wxMenuBar *menuBar = new wxMenuBar();
     
     m_bls_history = new wxFileHistory(MAX_RECENT_FILES_HISTORY, MENU_OPEN_RECENT);
@@ -99,6 +121,20 @@ frame_editor::frame_editor() : wxFrame(nullptr, wxID_ANY, wxintl::translate("PRO
     
     wxConfig::Get()->SetPath("/");
 
+    grayscale = wxConfig::Get()->ReadBool("GrayscaleRender", false);
+    bool perf_hud = wxConfig::Get()->ReadBool("PerfOverlay", false);
+    bool box_heatmap = wxConfig::Get()->ReadBool("BoxHeatmap", false);
+    m_memory_budget = int64_t(wxConfig::Get()->ReadLong("MemoryBudgetMegabytes", 1024)) * 1024 * 1024;
+
+    render_cache::get().setDirectory(std::filesystem::path(wxStandardPaths::Get().GetUserDir(wxStandardPaths::Dir_Cache).ToStdString()) / "blseditor" / "render");
+    render_cache::get().setMaxBytes(uintmax_t(wxConfig::Get()->ReadLong("RenderCacheMegabytes", 512)) * 1024 * 1024);
+    if (wxConfig::Get()->ReadBool("LayoutCache", true)) {
+        layout_cache::get().setDirectory(std::filesystem::path(wxStandardPaths::Get().GetUserDir(wxStandardPaths::Dir_Cache).ToStdString()) / "blseditor" / "layouts");
+    }
+    if (wxConfig::Get()->ReadBool("LayoutIndex", true)) {
+        layout_index::get().setFilename(std::filesystem::path(wxStandardPaths::Get().GetUserLocalDataDir().ToStdString()) / "layout_index.json");
+    }
+
     wxMenu *menuFile = new wxMenu;
     menuFile->Append(MENU_NEW, wxintl::translate("MENU_NEW"), wxintl::translate("MENU_NEW_HINT"));
     menuFile->Append(MENU_OPEN, wxintl::translate("MENU_OPEN"), wxintl::translate("MENU_OPEN_HINT"));
@@ -121,10 +157,20 @@ frame_editor::frame_editor() : wxFrame(nullptr, wxID_ANY, wxintl::translate("PRO
     menuEdit->Append(MENU_PASTE, wxintl::translate("MENU_PASTE"), wxintl::translate("MENU_PASTE_HINT"));
     menuEdit->AppendSeparator();
     menuEdit->Append(MENU_DELETE, wxintl::translate("MENU_DELETE"), wxintl::translate("MENU_DELETE_HINT"));
+    menuEdit->Append(MENU_CHANGE_MODE, wxintl::translate("MENU_CHANGE_MODE"), wxintl::translate("MENU_CHANGE_MODE_HINT"));
+    menuEdit->Append(MENU_CHANGE_PAGE, wxintl::translate("MENU_CHANGE_PAGE"), wxintl::translate("MENU_CHANGE_PAGE_HINT"));
     menuBar->Append(menuEdit, wxintl::translate("MENU_EDIT"));
 
     wxMenu *menuEditor = new wxMenu;
     menuEditor->Append(MENU_EDITCONTROL, wxintl::translate("MENU_EDITCONTROL"));
+    menuEditor->Append(MENU_SUGGEST_BOXES, wxintl::translate("MENU_SUGGEST_BOXES"), wxintl::translate("MENU_SUGGEST_BOXES_HINT"));
+    menuEditor->Append(MENU_VALIDATE_CORPUS, wxintl::translate("MENU_VALIDATE_CORPUS"), wxintl::translate("MENU_VALIDATE_CORPUS_HINT"));
+    menuEditor->Append(MENU_BUILD_LAYOUT_INDEX, wxintl::translate("MENU_BUILD_LAYOUT_INDEX"), wxintl::translate("MENU_BUILD_LAYOUT_INDEX_HINT"));
+    menuEditor->AppendCheckItem(MENU_GRAYSCALE, wxintl::translate("MENU_GRAYSCALE"), wxintl::translate("MENU_GRAYSCALE_HINT"))->Check(grayscale);
+    menuEditor->AppendSeparator();
+    menuEditor->AppendCheckItem(MENU_PERF_HUD, wxintl::translate("MENU_PERF_HUD"), wxintl::translate("MENU_PERF_HUD_HINT"))->Check(perf_hud);
+    menuEditor->AppendCheckItem(MENU_BOX_HEATMAP, wxintl::translate("MENU_BOX_HEATMAP"), wxintl::translate("MENU_BOX_HEATMAP_HINT"))->Check(box_heatmap);
+    menuEditor->Append(MENU_EXPORT_TRACE, wxintl::translate("MENU_EXPORT_TRACE"), wxintl::translate("MENU_EXPORT_TRACE_HINT"));
 
     menuBar->Append(menuEditor, wxintl::translate("MENU_EDITOR"));
 
@@ -188,13 +234,22 @@ frame_editor::frame_editor() : wxFrame(nullptr, wxID_ANY, wxintl::translate("PRO
     toolbar_side->Realize();
     sizer->Add(toolbar_side, wxSizerFlags().Expand());
 
-    m_list_boxes = new wxListBox(m_panel_left, CTL_LIST_BOXES);
+    m_list_boxes = new wxListBox(m_panel_left, CTL_LIST_BOXES, wxDefaultPosition, wxDefaultSize, 0, nullptr, wxLB_EXTENDED);
     sizer->Add(m_list_boxes, wxSizerFlags(1).Expand());
 
     m_panel_left->SetSizer(sizer);
-    m_image = new box_editor_panel(m_splitter, this);
 
-    m_splitter->SplitVertically(m_panel_left, m_image, 200);
+    wxSplitterWindow *m_splitter_right = new wxSplitterWindow(m_splitter);
+    m_image = new box_editor_panel(m_splitter_right, this);
+    m_image->setHudVisible(perf_hud);
+    m_image->setHeatmapVisible(box_heatmap);
+    m_thumbnails = new thumbnail_panel(m_splitter_right, this);
+
+    m_splitter_right->SplitVertically(m_image, m_thumbnails, -160);
+    m_splitter_right->SetSashGravity(1.0);
+    m_splitter_right->SetMinimumPaneSize(100);
+
+    m_splitter->SplitVertically(m_panel_left, m_splitter_right, 200);
     m_splitter->SetMinimumPaneSize(100);
 
     auto loadIcon = [&](const auto &resource) {
@@ -203,20 +258,57 @@ frame_editor::frame_editor() : wxFrame(nullptr, wxID_ANY, wxintl::translate("PRO
         return icon;
     };
 
+    Bind(wxEVT_COMMAND_PAGE_RENDERED, &frame_editor::OnPageRendered, this);
+    Bind(wxEVT_COMMAND_LAYOUT_SAVED, &frame_editor::OnLayoutSaved, this);
+
     SetIcon(loadIcon(icon_editor_png));
     Show();
 
     currentHistory = history.begin();
+
+    bool recovered = recoverJournal();
+    m_journal.reset(layout, recovered);
+    if (recovered) {
+        updateLayout();
+        modified = true;
+    }
+}
+
+bool frame_editor::recoverJournal() {
+    if (layout_journal::hasRecovery(layout.filename)) {
+        wxMessageDialog dialog(this, wxintl::translate("RECOVER_CHANGES_DIALOG"), wxintl::translate("PROGRAM_NAME"), wxYES_NO | wxICON_QUESTION);
+        if (dialog.ShowModal() == wxID_YES) {
+            try {
+                return layout_journal::recover(layout);
+            } catch (const std::exception &error) {
+                wxMessageBox(error.what(), wxintl::translate("PROGRAM_NAME"), wxICON_ERROR);
+            }
+        }
+    }
+    return false;
 }
 
 void frame_editor::openFile(const wxString &filename) {
     try {
         if (box_dialog::closeAll()) {
-            layout = layout_box_list(filename.ToStdString());
+            // a save may still be in flight, if it fails the current layout stays open.
+            // Failures are reported by OnLayoutSaved
+            std::string save_error;
+            if (!m_saver.flush(save_error)) return;
+
+            selectBox(nullptr);
+            layout = layout_cache::get().load(filename.ToStdString());
+            ++m_layout_generation;
+            bool recovered = recoverJournal();
 
             modified = false;
             history.clear();
+            m_journal.reset(layout, recovered);
             updateLayout();
+            modified = recovered;
+
+            // a session replays against the files it was started with
+            input_recorder::get().stop();
 
             wxConfig::Get()->SetPath("/RecentFiles");
             m_bls_history->AddFileToHistory(filename);
@@ -229,6 +321,7 @@ void frame_editor::openFile(const wxString &filename) {
 }
 
 bool frame_editor::save(bool saveAs) {
+    m_image->commitNudge();
     if (layout.filename.empty() || saveAs) {
         wxString lastLayoutDir = wxConfig::Get()->Read("LastLayoutDir");
         wxFileDialog diag(this, wxintl::translate("SAVE_LAYOUT_DIALOG"), lastLayoutDir, layout.filename.string(), 
@@ -240,63 +333,163 @@ bool frame_editor::save(bool saveAs) {
         wxConfig::Get()->Write("LastLayoutDir", wxFileName(diag.GetPath()).GetPath());
         layout.filename = diag.GetPath().ToStdString();
     }
-    try {
-        layout.save_file();
-    } catch (const std::exception &error) {
-        wxMessageBox(error.what(), wxintl::translate("PROGRAM_NAME"), wxICON_ERROR);
-        return false;
-    }
-    modified = false;
+    // the editor is marked clean by OnLayoutSaved, once the file is on disk
+    m_save_generation = m_layout_generation;
+    m_saver.save(layout, m_save_generation);
     return true;
 }
 
+void frame_editor::OnLayoutSaved(wxThreadEvent &evt) {
+    auto result = evt.GetPayload<layout_save_result>();
+    if (!result.error.empty()) {
+        m_save_generation = -1;
+        wxMessageBox(result.error, wxintl::translate("PROGRAM_NAME"), wxICON_ERROR);
+        return;
+    }
+    if (result.layout->filename != layout.filename) {
+        return;
+    }
+    m_journal.reset(*result.layout);
+    if (result.generation == m_layout_generation) {
+        modified = false;
+    } else {
+        m_journal.record(layout);
+    }
+}
+
 bool frame_editor::saveIfModified() {
-    if (modified) {
+    m_image->commitNudge();
+    if (modified && m_save_generation != m_layout_generation) {
         wxMessageDialog dialog(this, wxintl::translate("SAVE_CHANGES_DIALOG"), wxintl::translate("PROGRAM_NAME"), wxYES_NO | wxCANCEL | wxICON_WARNING);
 
         switch (dialog.ShowModal()) {
         case wxID_YES:
-            return save();
+            if (!save()) return false;
+            break;
         case wxID_NO:
+            m_journal.discard();
             return true;
         case wxID_CANCEL:
             return false;
         }
     }
-    return true;
+    // the layout may only be replaced once its last save is on disk, if that failed
+    // the layout and its journal are kept. The error is reported by OnLayoutSaved
+    std::string error;
+    return m_saver.flush(error);
+}
+
+// approximate heap usage of a copy of the layout, list nodes and strings included
+static int64_t layout_memory_usage(const layout_box_list &layout) {
+    int64_t bytes = sizeof(layout_box_list);
+    for (const auto &box : layout) {
+        bytes += sizeof(layout_box) + 2 * sizeof(void *)
+            + box.name.capacity() + box.script.capacity() + box.spacers.capacity() + box.goto_label.capacity();
+    }
+    return bytes;
 }
 
 void frame_editor::updateLayout(bool addToHistory) {
-    m_list_boxes->Clear();
+    TRACE_SCOPE("updateLayout");
+    ++m_layout_generation;
+
+    // any edit that updates the layout also records the boxes nudged so far
+    m_image->clearNudge();
+
+    // the list is replaced in one go, and the selection is kept for the boxes that still exist
+    wxArrayString items;
+    items.reserve(layout.size());
+    box_selection selection;
     for (auto &box : layout) {
         if (box.name.empty()) {
-            m_list_boxes->Append(wxintl::translate("UNNAMED_BOX"));
+            items.Add(wxintl::translate("UNNAMED_BOX"));
         } else {
-            m_list_boxes->Append(box.name);
+            items.Add(box.name);
+        }
+        if (m_selection.contains(&box)) {
+            selection.insert(&box);
         }
     }
+    m_selection = std::move(selection);
+    if (m_selected_box && !m_selection.contains(m_selected_box)) {
+        m_selected_box = nullptr;
+        m_image->setSelectedBox(nullptr);
+    }
+
+    m_list_boxes->Freeze();
+    m_list_boxes->Set(items);
+    syncListSelection();
+    m_list_boxes->Thaw();
+
     m_image->Refresh();
+    m_thumbnails->Refresh();
 
+    auto &history_bytes = perf_counters::get().history_bytes;
+    if (history.empty()) {
+        history_bytes.store(0, std::memory_order_relaxed);
+    }
     if (addToHistory) {
         if (!history.empty()) {
             modified = true;
         }
         while (!history.empty() && history.end() > currentHistory + 1) {
+            history_bytes -= layout_memory_usage(history.back());
             history.pop_back();
         }
         history.push_back(layout);
+        history_bytes += layout_memory_usage(history.back());
         if (history.size() > MAX_HISTORY_SIZE) {
+            history_bytes -= layout_memory_usage(history.front());
             history.pop_front();
         }
         currentHistory = history.end() - 1;
     }
+    m_journal.record(layout);
+    enforceMemoryBudget();
+}
+
+void frame_editor::enforceMemoryBudget() {
+    if (m_memory_budget <= 0 || memory_usage_total() <= m_memory_budget) return;
+    TRACE_SCOPE("enforceMemoryBudget");
+
+    auto over_budget = [&] {
+        return memory_usage_total() > m_memory_budget;
+    };
+
+    // from the cheapest to get back: recycled buffers, pages that can be rendered again,
+    // the slack of the zoomed page, the oldest undo steps, then the collapsed output rows
+    buffer_pool::get().trim();
+    while (over_budget() && m_page_cache.evict_oldest(selected_page)) {
+        buffer_pool::get().trim();
+    }
+    if (over_budget()) {
+        m_image->trimScaledImage();
+    }
+    while (over_budget() && currentHistory - history.begin() > MIN_UNDO_STEPS) {
+        ptrdiff_t current = currentHistory - history.begin();
+        perf_counters::get().history_bytes -= layout_memory_usage(history.front());
+        history.pop_front();
+        currentHistory = history.begin() + (current - 1);
+    }
+    if (over_budget() && m_output_dialog) {
+        m_output_dialog->releaseCollapsed();
+    }
 }
 
 void frame_editor::loadPdf(const wxString &filename) {
     try {
         m_doc.open(filename.ToStdString());
+        m_page_cache.clear();
+        try {
+            m_pdf_hash = hash_file(m_doc.filename());
+        } catch (const std::exception &) {
+            m_pdf_hash = 0;
+        }
+        m_thumbnails->loadDocument(m_doc, m_pdf_hash, rotation);
+        m_renderer.open(m_doc.filename(), m_pdf_hash);
         m_page->SetMaxPages(m_doc.num_pages());
         setSelectedPage(1, true);
+        input_recorder::get().stop();
 
         wxConfig::Get()->SetPath("/RecentPdfs");
         m_pdf_history->AddFileToHistory(m_doc.filename().string());
@@ -322,6 +515,7 @@ wxString frame_editor::getControlScript(bool open_dialog) {
 }
 
 void frame_editor::setSelectedPage(int page, bool force) {
+    TRACE_SCOPE("setSelectedPage");
     if (!force && page == selected_page) return;
     if (!m_doc.isopen()) return;
 
@@ -333,19 +527,166 @@ void frame_editor::setSelectedPage(int page, bool force) {
     selected_page = page;
 
     m_page->SetValue(page);
+    m_thumbnails->setSelectedPage(page);
+
+    if (auto raster = m_page_cache.find(page)) {
+        m_image->setImage(std::move(raster));
+        return;
+    }
 
-    pdf_image image = m_doc.render_page(page, rotation);
-    m_image->setImage(wxImage(image.width(), image.height(), image.release()));
+    // the thumbnail stands in for the page while it renders, so fast page flips never wait
+    if (const wxImage &thumbnail = m_thumbnails->getThumbnail(page); thumbnail.IsOk()) {
+        page_raster preview(thumbnail.GetWidth(), thumbnail.GetHeight(), 3);
+        memcpy(preview.data(), thumbnail.GetData(), preview.size_bytes());
+        m_image->setPreview(std::make_shared<const page_raster>(std::move(preview)));
+    } else {
+        // the last page must not stay on screen, with its ink, under the number of this one
+        m_image->setBlank();
+    }
+    m_renderer.request(page, rotation, grayscale);
+}
+
+void frame_editor::OnPageRendered(wxThreadEvent &evt) {
+    auto result = evt.GetPayload<page_render_result>();
+    if (result.generation != m_renderer.generation() || result.rotation != rotation || result.grayscale != grayscale) {
+        return;
+    }
+
+    if (!result.error.empty()) {
+        if (result.page != selected_page) return;
+        if (m_replay) {
+            m_replay->pageFailed(result.error);
+        } else {
+            wxMessageBox(result.error, wxintl::translate("PROGRAM_NAME"), wxICON_ERROR);
+        }
+        return;
+    }
+
+    auto raster = m_page_cache.insert(result.page, std::move(*result.raster));
+    enforceMemoryBudget();
+    if (m_pdf_hash && !result.from_disk) {
+        render_cache::get().storeAsync(render_key{m_pdf_hash, result.page, rotation, 0, grayscale ? 1 : 3}, raster);
+    }
+    if (result.page == selected_page) {
+        m_image->setImage(std::move(raster));
+        if (m_replay) {
+            m_image->Update();
+            m_replay->pageShown();
+        }
+    }
+}
+
+void frame_editor::startReplay(input_session session, const wxString &report_filename) {
+    m_replay = std::make_unique<session_replay>(this, std::move(session), report_filename);
+    m_replay->start();
+}
+
+bool frame_editor::replayEvent(const input_event &event) {
+    switch (event.type) {
+    case input_event_type::page_select:
+        setSelectedPage(event.value);
+        break;
+    case input_event_type::scale_change:
+    case input_event_type::scale_final:
+        m_scale->SetValue(event.value);
+        m_image->rescale(event.value / 100.f, event.type == input_event_type::scale_final ? wxIMAGE_QUALITY_HIGH : wxIMAGE_QUALITY_NORMAL);
+        break;
+    case input_event_type::tool_change:
+        m_image->setSelectedTool(event.value);
+        break;
+    default:
+        m_image->replayMouseEvent(event);
+    }
+    m_image->Update();
+    return event.type != input_event_type::page_select || !m_doc.isopen() || m_page_cache.contains(selected_page);
+}
+
+void frame_editor::endReplay() {
+    // the edits made by the replay are thrown away with the journal
+    modified = false;
+    Close(true);
+}
+
+void frame_editor::setBoxProfile(box_profile profile) {
+    m_box_profile = std::move(profile);
+    m_image->updateHeatmap();
 }
 
 void frame_editor::selectBox(layout_box *box) {
-    m_image->setSelectedBox(box);
     if (box) {
-        m_list_boxes->SetSelection(std::distance(layout.begin(),
-            std::ranges::find(layout, box,
-            [](const auto &box) { return &box; })));
+        selectBoxes({box}, box);
     } else {
-        m_list_boxes->SetSelection(-1);
+        selectBoxes({});
     }
+}
+
+void frame_editor::selectBoxes(const std::vector<layout_box *> &boxes, layout_box *focus) {
+    m_selection = box_selection(boxes.begin(), boxes.end());
+    if (!focus || !m_selection.contains(focus)) {
+        focus = boxes.empty() ? nullptr : boxes.front();
+    }
+    m_selected_box = focus;
+    m_image->setSelectedBox(focus);
+    syncListSelection();
     m_image->Refresh();
+}
+
+void frame_editor::toggleBoxSelection(layout_box *box) {
+    if (m_selection.erase(box)) {
+        if (m_selected_box == box) {
+            auto selected = getSelectedBoxes();
+            m_selected_box = selected.empty() ? nullptr : selected.front();
+        }
+    } else {
+        m_selection.insert(box);
+        m_selected_box = box;
+    }
+    m_image->setSelectedBox(m_selected_box);
+    syncListSelection();
+    m_image->Refresh();
+}
+
+std::vector<layout_box *> frame_editor::getSelectedBoxes() {
+    std::vector<layout_box *> ret;
+    if (m_selection.empty()) return ret;
+    for (auto &box : layout) {
+        if (m_selection.contains(&box)) {
+            ret.push_back(&box);
+        }
+    }
+    return ret;
+}
+
+void frame_editor::syncListSelection() {
+    m_list_boxes->DeselectAll();
+    if (m_selection.empty()) return;
+    int index = 0;
+    for (auto &box : layout) {
+        if (m_selection.contains(&box)) {
+            m_list_boxes->SetSelection(index);
+        }
+        ++index;
+    }
+    if (m_selected_box) {
+        m_list_boxes->EnsureVisible(std::distance(layout.begin(), std::ranges::find(layout, m_selected_box,
+            [](const auto &box) { return &box; })));
+    }
+}
+
+bool frame_editor::deleteBoxes(const std::vector<layout_box *> &boxes) {
+    for (layout_box *box : boxes) {
+        if (!box_dialog::closeDialog(*box)) return false;
+    }
+    // boxes are deselected before they are freed, so that a new box at the same address is never selected
+    for (layout_box *box : boxes) {
+        m_selection.erase(box);
+    }
+    if (!m_selection.contains(m_selected_box)) {
+        m_selected_box = nullptr;
+        m_image->setSelectedBox(nullptr);
+    }
+    std::set<const layout_box *> erased(boxes.begin(), boxes.end());
+    layout.remove_if([&](const layout_box &box) { return erased.contains(&box); });
+    updateLayout();
+    return true;
 }
\ No newline at end of file
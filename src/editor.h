@@ -11,14 +11,25 @@
 #include <wx/filehistory.h>
 
 #include "page_ctl.h"
+#include "page_cache.h"
+#include "page_renderer.h"
+#include "layout_journal.h"
+#include "layout_saver.h"
+#include "session_replay.h"
+#include "box_profile.h"
 
 #include "layout.h"
 #include "wxintl.h"
 
 #include <deque>
+#include <memory>
+#include <set>
+#include <vector>
 
 using namespace bls;
 
+using box_selection = std::set<layout_box *, std::less<>>;
+
 constexpr size_t MAX_RECENT_FILES_HISTORY = 10;
 constexpr size_t MAX_RECENT_PDFS_HISTORY = 10;
 
@@ -30,7 +41,24 @@ public:
         return selected_page;
     }
     void setSelectedPage(int page, bool force = false);
+
+    // the selection is a set of boxes, one of which is the focus of single box operations
     void selectBox(layout_box *box);
+    void selectBoxes(const std::vector<layout_box *> &boxes, layout_box *focus = nullptr);
+    void toggleBoxSelection(layout_box *box);
+    bool isBoxSelected(const layout_box *box) const {
+        return m_selection.contains(box);
+    }
+    layout_box *getSelectedBox() {
+        return m_selected_box;
+    }
+    const box_selection &getSelection() const {
+        return m_selection;
+    }
+    std::vector<layout_box *> getSelectedBoxes();
+
+    // removes the boxes with a single history entry, false if a box dialog refused to close
+    bool deleteBoxes(const std::vector<layout_box *> &boxes);
     
     void openFile(const wxString &filename);
     void loadPdf(const wxString &pdf_filename);
@@ -43,6 +71,31 @@ public:
         return m_doc;
     }
 
+    // changes whenever the boxes of the layout may have been added, removed or moved
+    int getLayoutGeneration() const {
+        return m_layout_generation;
+    }
+
+    // plays a recorded input session back and writes the latency of its events to report_filename
+    void startReplay(input_session session, const wxString &report_filename);
+
+    // applies a recorded event, false if its page is still rendering
+    bool replayEvent(const input_event &event);
+    void endReplay();
+
+    // frees caches, old undo steps and collapsed output until the editor is within its memory budget
+    void enforceMemoryBudget();
+
+    int64_t getMemoryBudget() const {
+        return m_memory_budget;
+    }
+
+    // per box timings of the last profiled read, drawn as a heat map over the page
+    void setBoxProfile(box_profile profile);
+    const box_profile &getBoxProfile() const {
+        return m_box_profile;
+    }
+
     int getBoxRotation() {
         return (4 - rotation) % 4;
     }
@@ -64,16 +117,27 @@ private:
     void OnPaste        (wxCommandEvent &evt);
     void OpenControlScript (wxCommandEvent &evt);
     void OnOpenLayoutOptions (wxCommandEvent &evt);
+    void OnSuggestBoxes (wxCommandEvent &evt);
+    void OnValidateCorpus (wxCommandEvent &evt);
+    void OnBuildLayoutIndex (wxCommandEvent &evt);
+    void OnToggleGrayscale (wxCommandEvent &evt);
+    void OnExportTrace  (wxCommandEvent &evt);
+    void OnTogglePerfHud (wxCommandEvent &evt);
+    void OnToggleHeatmap (wxCommandEvent &evt);
     void OnFindLayout   (wxCommandEvent &evt);
     void OnRotate       (wxCommandEvent &evt);
     void OnLoadPdf      (wxCommandEvent &evt);
     void OnPageSelect   (wxCommandEvent &evt);
+    void OnPageRendered (wxThreadEvent &evt);
+    void OnLayoutSaved  (wxThreadEvent &evt);
     void OnScaleChange  (wxScrollEvent &evt);
     void OnScaleChangeFinal (wxScrollEvent &evt);
     void OnChangeTool   (wxCommandEvent &evt);
     void OnSelectBox    (wxCommandEvent &evt);
     void EditSelectedBox(wxCommandEvent &evt);
     void OnDelete       (wxCommandEvent &evt);
+    void OnChangeMode   (wxCommandEvent &evt);
+    void OnChangePage   (wxCommandEvent &evt);
     void OnReadData     (wxCommandEvent &evt);
     void OnMoveUp       (wxCommandEvent &evt);
     void OnMoveDown     (wxCommandEvent &evt);
@@ -83,6 +147,8 @@ private:
 
 private:
     class box_editor_panel *m_image;
+    class thumbnail_panel *m_thumbnails;
+    class output_dialog *m_output_dialog = nullptr;
 
     wxFileHistory *m_bls_history;
     wxMenu *m_bls_history_menu;
@@ -98,12 +164,40 @@ private:
     std::deque<layout_box_list> history;
     std::deque<layout_box_list>::iterator currentHistory;
 
+    layout_journal m_journal;
+    layout_saver m_saver;
+
+    // bumped on every change of the layout, a save only marks the editor clean if it still matches
+    int m_layout_generation = 0;
+    int m_save_generation = -1;
+
     bool modified = false;
     int rotation = 0;
+    bool grayscale = false;
+
+    box_profile m_box_profile;
+
+    box_selection m_selection;
+    layout_box *m_selected_box = nullptr;
+
+private:
+    bool recoverJournal();
+
+    // runs the control script in find layout mode, returns the layout it picked
+    std::filesystem::path findLayoutWithScript(const pdf_document &doc);
+    void syncListSelection();
 
 private:
     pdf_document m_doc;
+    uint64_t m_pdf_hash = 0;
+    page_cache m_page_cache;
+    page_renderer m_renderer;
     int selected_page = 0;
+
+    // in bytes, 0 for no limit
+    int64_t m_memory_budget = 0;
+
+    std::unique_ptr<session_replay> m_replay;
 };
 
 #endif
\ No newline at end of file
@@ -2,6 +2,9 @@
 
 #include <wx/filename.h>
 #include <wx/config.h>
+#include <wx/choicdlg.h>
+#include <wx/dirdlg.h>
+#include <wx/progdlg.h>
 
 #include <fstream>
 
@@ -11,15 +14,25 @@
 #include "box_editor_panel.h"
 #include "box_dialog.h"
 #include "output_dialog.h"
+#include "corpus_dialog.h"
+#include "corpus_runner.h"
+#include "layout_index.h"
 #include "reader.h"
 #include "layout_options_dialog.h"
+#include "thumbnail_panel.h"
+#include "move_page_dialog.h"
+#include "input_session.h"
+#include "trace.h"
 
 void frame_editor::OnNewFile(wxCommandEvent &evt) {
     if (box_dialog::closeAll() && saveIfModified()) {
         modified = false;
+        selectBox(nullptr);
         layout.clear();
         history.clear();
+        m_journal.reset(layout);
         updateLayout(false);
+        input_recorder::get().stop();
     }
 }
 
@@ -60,8 +73,10 @@ void frame_editor::OnMenuClose(wxCommandEvent &evt) {
 }
 
 void frame_editor::OnUndo(wxCommandEvent &evt) {
+    m_image->commitNudge();
     if (currentHistory > history.begin()) {
         if (box_dialog::closeAll()) {
+            selectBox(nullptr);
             --currentHistory;
             layout = *currentHistory;
             updateLayout(false);
@@ -72,8 +87,10 @@ void frame_editor::OnUndo(wxCommandEvent &evt) {
 }
 
 void frame_editor::OnRedo(wxCommandEvent &evt) {
+    m_image->commitNudge();
     if (currentHistory < history.end() - 1) {
         if (box_dialog::closeAll()) {
+            selectBox(nullptr);
             ++currentHistory;
             layout = *currentHistory;
             updateLayout(false);
@@ -84,40 +101,43 @@ void frame_editor::OnRedo(wxCommandEvent &evt) {
 }
 
 void frame_editor::OnCut(wxCommandEvent &evt) {
-    int selection = m_list_boxes->GetSelection();
-    if (selection >= 0) {
-        auto it = std::next(layout.begin(), selection);
-        if (SetClipboard(*it) && box_dialog::closeDialog(*it)) {
-            layout.erase(it);
-            updateLayout();
-        }
+    auto selected = getSelectedBoxes();
+    if (selected.empty()) return;
+
+    std::vector<layout_box> boxes;
+    for (layout_box *box : selected) {
+        boxes.push_back(*box);
+    }
+    if (SetClipboard(boxes)) {
+        deleteBoxes(selected);
     }
 }
 
 void frame_editor::OnCopy(wxCommandEvent &evt) {
-    int selection = m_list_boxes->GetSelection();
-    if (selection >= 0) {
-        auto it = std::next(layout.begin(), selection);
-        SetClipboard(*it);
+    std::vector<layout_box> boxes;
+    for (layout_box *box : getSelectedBoxes()) {
+        boxes.push_back(*box);
+    }
+    if (!boxes.empty()) {
+        SetClipboard(boxes);
     }
 }
 
 void frame_editor::OnPaste(wxCommandEvent &evt) {
-    layout_box clipboard;
-    if (!GetClipboard(clipboard)) return;
+    std::vector<layout_box> clipboard;
+    if (!GetClipboard(clipboard) || clipboard.empty()) return;
     
-    if (clipboard.page != selected_page) {
-        clipboard.page = selected_page;
-    }
-    
-    int selection = m_list_boxes->GetSelection();
     layout_box_list::const_iterator selected = layout.end();
-    if (selection >= 0) {
-        selected = std::next(layout.begin(), selection);
+    if (m_selected_box) {
+        selected = std::ranges::find(layout, m_selected_box, [](const auto &box) { return &box; });
+    }
+    std::vector<layout_box *> pasted;
+    for (auto &box : clipboard) {
+        box.page = selected_page;
+        pasted.push_back(&*layout.emplace(selected, std::move(box)));
     }
-    auto &box = *layout.emplace(selected, std::move(clipboard));
     updateLayout();
-    selectBox(&box);
+    selectBoxes(pasted);
 }
 
 void frame_editor::OpenControlScript(wxCommandEvent &evt) {
@@ -125,24 +145,115 @@ void frame_editor::OpenControlScript(wxCommandEvent &evt) {
 }
 
 void frame_editor::OnOpenLayoutOptions(wxCommandEvent &evt) {
-    LayoutOptionsDialog(this, &layout).ShowModal();
+    if (LayoutOptionsDialog(this, &layout).ShowModal() == wxID_OK) {
+        updateLayout();
+    }
+}
+
+void frame_editor::OnSuggestBoxes(wxCommandEvent &evt) {
+    auto is_covered = [&](const pdf_rect &rect) {
+        float cx = rect.x + rect.w * 0.5f;
+        float cy = rect.y + rect.h * 0.5f;
+        return std::ranges::any_of(layout, [&](const layout_box &box) {
+            return box.page == rect.page && cx > box.x && cx < box.x + box.w && cy > box.y && cy < box.y + box.h;
+        });
+    };
+
+    bool added = false;
+    for (const pdf_rect &rect : m_image->suggestBoxes()) {
+        if (is_covered(rect)) continue;
+        layout_box &box = layout.emplace_back();
+        box.x = rect.x;
+        box.y = rect.y;
+        box.w = rect.w;
+        box.h = rect.h;
+        box.page = rect.page;
+        added = true;
+    }
+    if (added) {
+        updateLayout();
+    } else {
+        wxBell();
+    }
+}
+
+void frame_editor::OnValidateCorpus(wxCommandEvent &evt) {
+    wxDirDialog diag(this, wxintl::translate("CORPUS_FOLDER_DIALOG"), wxConfig::Get()->Read("CorpusFolder"), wxDD_DEFAULT_STYLE | wxDD_DIR_MUST_EXIST);
+
+    if (diag.ShowModal() == wxID_CANCEL)
+        return;
+
+    wxConfig::Get()->Write("CorpusFolder", diag.GetPath());
+    corpus_dialog(this, diag.GetPath()).ShowModal();
+}
+
+std::filesystem::path frame_editor::findLayoutWithScript(const pdf_document &doc) {
+    reader my_reader;
+    my_reader.set_document(doc);
+    my_reader.add_layout(layout_box_list(getControlScript().ToStdString()));
+    my_reader.add_flag(reader_flags::FIND_LAYOUT);
+    my_reader.start();
+    return my_reader.get_current_layout();
+}
+
+void frame_editor::OnBuildLayoutIndex(wxCommandEvent &evt) {
+    wxDirDialog diag(this, wxintl::translate("LAYOUT_INDEX_FOLDER_DIALOG"), wxConfig::Get()->Read("CorpusFolder"), wxDD_DEFAULT_STYLE | wxDD_DIR_MUST_EXIST);
+
+    if (diag.ShowModal() == wxID_CANCEL)
+        return;
+
+    std::filesystem::path folder = diag.GetPath().ToStdString();
+    auto files = list_corpus(folder);
+    wxProgressDialog progress(wxintl::translate("LAYOUT_INDEX_PROGRESS"), wxEmptyString, int(files.size()), this,
+        wxPD_APP_MODAL | wxPD_AUTO_HIDE | wxPD_CAN_ABORT | wxPD_ELAPSED_TIME | wxPD_REMAINING_TIME);
+
+    // each PDF is identified by the control script once, and teaches the index its layout
+    bool learned = false;
+    for (size_t i = 0; i < files.size(); ++i) {
+        if (!progress.Update(int(i), wxintl::to_wx(files[i]))) break;
+        try {
+            pdf_document doc;
+            doc.open((folder / std::filesystem::path(files[i])).string());
+            pdf_fingerprint fingerprint = pdf_fingerprint::extract(doc);
+            learned |= layout_index::get().learn(findLayoutWithScript(doc).string(), fingerprint);
+        } catch (const std::exception &) {
+            // PDFs the control script can't identify are left out of the index
+        }
+    }
+
+    if (!learned) return;
+    try {
+        layout_index::get().save();
+    } catch (const std::exception &error) {
+        wxMessageBox(error.what(), wxintl::translate("PROGRAM_NAME"), wxICON_ERROR);
+    }
 }
 
 void frame_editor::OnFindLayout(wxCommandEvent &evt) {
+    TRACE_SCOPE("OnFindLayout");
     if (!m_doc.isopen()) {
         wxBell();
         return;
     }
 
     try {
-        reader my_reader;
-        my_reader.set_document(m_doc);
-        my_reader.add_layout(layout_box_list(getControlScript().ToStdString()));
-        my_reader.add_flag(reader_flags::FIND_LAYOUT);
-        my_reader.start();
+        // the control script is only run when the index has no single candidate for the PDF
+        // only the answers of the script are learned, the index would otherwise confirm its own guesses
+        pdf_fingerprint fingerprint = pdf_fingerprint::extract(m_doc);
+        std::filesystem::path found;
+        bool learned = false;
+        if (auto candidate = layout_index::get().identify(fingerprint); candidate && std::filesystem::exists(*candidate)) {
+            found = *candidate;
+        } else {
+            found = findLayoutWithScript(m_doc);
+            learned = layout_index::get().learn(found.string(), fingerprint);
+        }
 
         if (saveIfModified()) {
-            openFile(my_reader.get_current_layout().string());
+            openFile(found.string());
+        }
+        if (learned) {
+            layout_index::get().save();
         }
     } catch (const std::exception &error) {
         wxMessageBox(error.what(), wxintl::translate("PROGRAM_NAME"), wxICON_ERROR);
@@ -152,9 +263,49 @@ void frame_editor::OnFindLayout(wxCommandEvent &evt) {
 void frame_editor::OnRotate(wxCommandEvent &evt) {
     ++rotation %= 4;
 
+    // pages are rendered again, the direction in which render_page turns them is left to the renderer.
+    // Box coordinates stay relative to the displayed page
+    m_page_cache.clear();
+    m_thumbnails->setRotation(rotation);
     setSelectedPage(selected_page, true);
 }
 
+void frame_editor::OnToggleGrayscale(wxCommandEvent &evt) {
+    grayscale = evt.IsChecked();
+    wxConfig::Get()->Write("GrayscaleRender", grayscale);
+
+    if (grayscale) {
+        m_page_cache.to_grayscale();
+    } else {
+        m_page_cache.clear();
+    }
+    setSelectedPage(selected_page, true);
+}
+
+void frame_editor::OnTogglePerfHud(wxCommandEvent &evt) {
+    wxConfig::Get()->Write("PerfOverlay", evt.IsChecked());
+    m_image->setHudVisible(evt.IsChecked());
+}
+
+void frame_editor::OnToggleHeatmap(wxCommandEvent &evt) {
+    wxConfig::Get()->Write("BoxHeatmap", evt.IsChecked());
+    m_image->setHeatmapVisible(evt.IsChecked());
+}
+
+void frame_editor::OnExportTrace(wxCommandEvent &evt) {
+    wxFileDialog diag(this, wxintl::translate("EXPORT_TRACE_DIALOG"), wxEmptyString, "blseditor_trace.json",
+        wxintl::to_wx(std::format("{} (*.json)|*.json|{} (*.*)|*.*", intl::translate("Trace files"), intl::translate("All files"))), wxFD_SAVE | wxFD_OVERWRITE_PROMPT);
+
+    if (diag.ShowModal() == wxID_CANCEL)
+        return;
+
+    try {
+        tracer::get().exportChrome(diag.GetPath().ToStdString());
+    } catch (const std::exception &error) {
+        wxMessageBox(error.what(), wxintl::translate("PROGRAM_NAME"), wxICON_ERROR);
+    }
+}
+
 void frame_editor::OnLoadPdf(wxCommandEvent &evt) {
     wxString lastPdfDir = wxConfig::Get()->Read("LastPdfDir");
     wxFileDialog diag(this, wxintl::translate("OPEN_PDF_DIALOG"), lastPdfDir, wxEmptyString,
@@ -171,78 +322,124 @@ void frame_editor::OnLoadPdf(wxCommandEvent &evt) {
 void frame_editor::OnPageSelect(wxCommandEvent &evt) {
     if (!m_doc.isopen()) return;
 
+    input_recorder::get().record(input_event_type::page_select, evt.GetInt());
     setSelectedPage(evt.GetInt());
 }
 
 void frame_editor::OnChangeTool(wxCommandEvent &evt) {
+    input_recorder::get().record(input_event_type::tool_change, evt.GetId());
     m_image->setSelectedTool(evt.GetId());
 }
 
 void frame_editor::OnSelectBox(wxCommandEvent &evt) {
-    int selection = m_list_boxes->GetSelection();
-    if (selection >= 0 && selection < (int) layout.size()) {
-        auto it = std::next(layout.begin(), selection);
-        selectBox(&*it);
-    } else {
-        selectBox(nullptr);
+    wxArrayInt selections;
+    m_list_boxes->GetSelections(selections);
+    std::set<int> indices(selections.begin(), selections.end());
+
+    std::vector<layout_box *> boxes;
+    layout_box *focus = nullptr;
+    int index = 0;
+    for (auto &box : layout) {
+        if (indices.contains(index)) {
+            boxes.push_back(&box);
+            if (index == evt.GetSelection()) {
+                focus = &box;
+            }
+        }
+        ++index;
     }
+    selectBoxes(boxes, focus);
 }
 
 void frame_editor::EditSelectedBox(wxCommandEvent &evt) {
-    int selection = m_list_boxes->GetSelection();
-    if (selection >= 0 && selection < (int) layout.size()) {
-        auto it = std::next(layout.begin(), selection);
-        box_dialog::openDialog(this, *it);
+    if (m_selected_box) {
+        box_dialog::openDialog(this, *m_selected_box);
     }
 }
 
 void frame_editor::OnDelete(wxCommandEvent &evt) {
-    int selection = m_list_boxes->GetSelection();
-    if (selection >= 0 && selection < (int) layout.size()) {
-        auto it = std::next(layout.begin(), selection);
-        if (box_dialog::closeDialog(*it)) {
-            layout.erase(it);
-            updateLayout();
+    auto selected = getSelectedBoxes();
+    if (!selected.empty()) {
+        deleteBoxes(selected);
+    }
+}
+
+void frame_editor::OnChangeMode(wxCommandEvent &evt) {
+    auto selected = getSelectedBoxes();
+    if (selected.empty()) {
+        wxBell();
+        return;
+    }
+
+    static auto choices = []<read_mode ... Es> (enums::enum_sequence<Es...>) {
+        wxString strings[] = {wxintl::enum_label(Es) ... };
+        return wxArrayString(sizeof(strings) / sizeof(wxString), strings);
+    } (enums::make_enum_sequence<read_mode>());
+    wxSingleChoiceDialog diag(this, wxintl::translate("DIALOG_CHANGE_MODE"), wxintl::translate("MENU_CHANGE_MODE"), choices);
+    diag.SetSelection(static_cast<int>(m_selected_box ? m_selected_box->mode : selected.front()->mode));
+    if (diag.ShowModal() == wxID_OK) {
+        for (layout_box *box : selected) {
+            box->mode = static_cast<read_mode>(diag.GetSelection());
         }
+        updateLayout();
     }
 }
 
+void frame_editor::OnChangePage(wxCommandEvent &evt) {
+    auto selected = getSelectedBoxes();
+    if (selected.empty() || !m_doc.isopen()) {
+        wxBell();
+        return;
+    }
+    MovePageDialog(this, selected).ShowModal();
+}
+
 void frame_editor::OnReadData(wxCommandEvent &evt) {
-    static output_dialog *diag = new output_dialog(this);
-    diag->compileAndRead();
-    diag->Show();
+    if (!m_output_dialog) {
+        m_output_dialog = new output_dialog(this);
+    }
+    m_output_dialog->compileAndRead();
+    m_output_dialog->Show();
 }
 
 void frame_editor::OnMoveUp(wxCommandEvent &evt) {
-    int selection = m_list_boxes->GetSelection();
-    if (selection > 0) {
-        auto it = std::next(layout.begin(), selection);
+    if (!m_selected_box) return;
+    auto it = std::ranges::find(layout, m_selected_box, [](const auto &box) { return &box; });
+    if (it != layout.begin()) {
         layout.splice(std::prev(it), layout, it);
         updateLayout();
-        selectBox(&*it);
     }
 }
 
 void frame_editor::OnMoveDown(wxCommandEvent &evt) {
-    int selection = m_list_boxes->GetSelection();
-    if (selection >= 0 && selection < (int)layout.size() - 1) {
-        auto it = std::next(layout.begin(), selection);
+    if (!m_selected_box) return;
+    auto it = std::ranges::find(layout, m_selected_box, [](const auto &box) { return &box; });
+    if (std::next(it) != layout.end()) {
         layout.splice(it, layout, std::next(it));
         updateLayout();
-        selectBox(&*it);
     }
 }
 
 void frame_editor::OnScaleChange(wxScrollEvent &evt) {
+    input_recorder::get().record(input_event_type::scale_change, m_scale->GetValue());
     m_image->rescale(m_scale->GetValue() / 100.f);
 }
 
 void frame_editor::OnScaleChangeFinal(wxScrollEvent &evt) {
+    input_recorder::get().record(input_event_type::scale_final, m_scale->GetValue());
     m_image->rescale(m_scale->GetValue() / 100.f, wxIMAGE_QUALITY_HIGH);
+    enforceMemoryBudget();
 }
 
 void frame_editor::OnFrameClose(wxCloseEvent &evt) {
+    // saveIfModified also waits for the last save, and fails if it could not be written
     if (saveIfModified()) {
+        m_journal.discard();
+        evt.Skip();
+    } else if (evt.CanVeto()) {
+        evt.Veto();
+    } else {
+        // the journal stays, so the changes are recovered on the next start
         evt.Skip();
     }
 }
\ No newline at end of file
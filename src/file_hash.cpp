@@ -0,0 +1,64 @@
+#include "file_hash.h"
+
+#include <fstream>
+#include <vector>
+#include <cstring>
+#include <format>
+#include <stdexcept>
+
+constexpr uint64_t HASH_MULTIPLIER = 0x9e3779b97f4a7c15ull;
+constexpr size_t HASH_CHUNK_SIZE = 1 << 20;
+
+static inline uint64_t mix(uint64_t h, uint64_t word) {
+    h ^= word * HASH_MULTIPLIER;
+    h = (h << 31) | (h >> 33);
+    return h * 0xbf58476d1ce4e5b9ull;
+}
+
+static inline uint64_t finalize(uint64_t h) {
+    h ^= h >> 30;
+    h *= 0xbf58476d1ce4e5b9ull;
+    h ^= h >> 27;
+    h *= 0x94d049bb133111ebull;
+    return h ^ (h >> 31);
+}
+
+static uint64_t hash_update(uint64_t h, const uint8_t *data, size_t size) {
+    size_t i = 0;
+    for (; i + 8 <= size; i += 8) {
+        uint64_t word;
+        memcpy(&word, data + i, 8);
+        h = mix(h, word);
+    }
+    if (i < size) {
+        uint64_t word = 0;
+        memcpy(&word, data + i, size - i);
+        h = mix(h, word);
+    }
+    return h;
+}
+
+uint64_t hash_bytes(const void *data, size_t size, uint64_t seed) {
+    return finalize(hash_update(seed ^ size, static_cast<const uint8_t *>(data), size));
+}
+
+uint64_t hash_file(const std::filesystem::path &filename) {
+    std::ifstream ifs(filename, std::ios::binary);
+    if (!ifs) {
+        throw std::runtime_error(std::format("Can't open {}", filename.string()));
+    }
+    std::vector<uint8_t> buffer(HASH_CHUNK_SIZE);
+    uint64_t h = 0;
+    size_t total = 0;
+    while (ifs) {
+        ifs.read(reinterpret_cast<char *>(buffer.data()), buffer.size());
+        size_t count = ifs.gcount();
+        h = hash_update(h, buffer.data(), count);
+        total += count;
+    }
+    return finalize(h ^ total);
+}
+
+std::string hash_to_hex(uint64_t hash) {
+    return std::format("{:016x}", hash);
+}
\ No newline at end of file
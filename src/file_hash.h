@@ -0,0 +1,19 @@
+#ifndef __FILE_HASH_H__
+#define __FILE_HASH_H__
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <filesystem>
+
+// 64 bit content hash, used to key on-disk caches by file contents instead of file names
+uint64_t hash_bytes(const void *data, size_t size, uint64_t seed = 0);
+uint64_t hash_file(const std::filesystem::path &filename);
+
+inline uint64_t hash_string(std::string_view str, uint64_t seed = 0) {
+    return hash_bytes(str.data(), str.size(), seed);
+}
+
+std::string hash_to_hex(uint64_t hash);
+
+#endif
\ No newline at end of file
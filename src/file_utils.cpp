@@ -0,0 +1,116 @@
+#include "file_utils.h"
+
+#include <format>
+#include <stdexcept>
+#include <chrono>
+
+#ifdef _WIN32
+    #include <io.h>
+    #include <fcntl.h>
+#else
+    #include <unistd.h>
+    #include <fcntl.h>
+#endif
+
+bool sync_file(FILE *file) {
+    if (fflush(file) != 0) return false;
+#ifdef _WIN32
+    return _commit(_fileno(file)) == 0;
+#else
+    return fsync(fileno(file)) == 0;
+#endif
+}
+
+bool sync_file(const std::filesystem::path &filename) {
+#ifdef _WIN32
+    int fd = _wopen(filename.c_str(), _O_RDWR | _O_BINARY);
+    if (fd < 0) return false;
+    bool ret = _commit(fd) == 0;
+    _close(fd);
+#else
+    int fd = open(filename.c_str(), O_RDWR);
+    if (fd < 0) return false;
+    bool ret = fsync(fd) == 0;
+    close(fd);
+#endif
+    return ret;
+}
+
+std::filesystem::path temp_filename_for(const std::filesystem::path &filename) {
+    auto ret = filename;
+    ret += std::format(".{}.tmp", std::chrono::steady_clock::now().time_since_epoch().count());
+    return ret;
+}
+
+void atomic_replace_file(const std::filesystem::path &tmp_filename, const std::filesystem::path &filename) {
+    std::error_code ec;
+    std::filesystem::rename(tmp_filename, filename, ec);
+    if (ec) {
+        std::filesystem::remove(tmp_filename, ec);
+        throw std::runtime_error(std::format("Can't write {}", filename.string()));
+    }
+}
+
+static FILE *open_for_writing(const std::filesystem::path &filename) {
+#ifdef _WIN32
+    return _wfopen(filename.c_str(), L"wb");
+#else
+    return fopen(filename.c_str(), "wb");
+#endif
+}
+
+void atomic_write_file(const std::filesystem::path &filename, std::string_view data) {
+    auto tmp_filename = temp_filename_for(filename);
+
+    FILE *file = open_for_writing(tmp_filename);
+    if (!file) {
+        throw std::runtime_error(std::format("Can't write {}", filename.string()));
+    }
+    bool ok = fwrite(data.data(), 1, data.size(), file) == data.size() && sync_file(file);
+    ok = fclose(file) == 0 && ok;
+    if (!ok) {
+        std::error_code ec;
+        std::filesystem::remove(tmp_filename, ec);
+        throw std::runtime_error(std::format("Can't write {}", filename.string()));
+    }
+
+    atomic_replace_file(tmp_filename, filename);
+}
+
+atomic_file_writer::atomic_file_writer(const std::filesystem::path &filename, size_t buffer_size)
+    : m_filename(filename), m_tmp_filename(temp_filename_for(filename)), m_buffer_size(buffer_size)
+{
+    m_file = open_for_writing(m_tmp_filename);
+    if (!m_file) {
+        throw std::runtime_error(std::format("Can't write {}", m_filename.string()));
+    }
+    m_buffer.reserve(buffer_size + buffer_size / 4);
+}
+
+atomic_file_writer::~atomic_file_writer() {
+    if (m_file) {
+        fclose(m_file);
+        std::error_code ec;
+        std::filesystem::remove(m_tmp_filename, ec);
+    }
+}
+
+void atomic_file_writer::flush() {
+    if (!m_buffer.empty() && fwrite(m_buffer.data(), 1, m_buffer.size(), m_file) != m_buffer.size()) {
+        throw std::runtime_error(std::format("Can't write {}", m_filename.string()));
+    }
+    m_buffer.clear();
+}
+
+void atomic_file_writer::commit() {
+    flush();
+    bool ok = sync_file(m_file);
+    ok = fclose(m_file) == 0 && ok;
+    m_file = nullptr;
+    if (!ok) {
+        std::error_code ec;
+        std::filesystem::remove(m_tmp_filename, ec);
+        throw std::runtime_error(std::format("Can't write {}", m_filename.string()));
+    }
+    atomic_replace_file(m_tmp_filename, m_filename);
+}
\ No newline at end of file
@@ -0,0 +1,60 @@
+#ifndef __FILE_UTILS_H__
+#define __FILE_UTILS_H__
+
+#include <cstdio>
+#include <filesystem>
+#include <string>
+#include <string_view>
+
+// Flushes a stdio stream and asks the OS to commit it to the storage device
+bool sync_file(FILE *file);
+
+// Commits an already written file to the storage device
+bool sync_file(const std::filesystem::path &filename);
+
+// Writes data to a temporary file next to filename, syncs it and renames it over filename,
+// so that readers only ever see the old or the new contents. Throws std::runtime_error.
+void atomic_write_file(const std::filesystem::path &filename, std::string_view data);
+
+// Renames a completely written temporary file over filename
+void atomic_replace_file(const std::filesystem::path &tmp_filename, const std::filesystem::path &filename);
+
+std::filesystem::path temp_filename_for(const std::filesystem::path &filename);
+
+// Streams data to a temporary file next to filename through a buffer, commit() syncs it
+// and renames it over filename. Without a commit the temporary file is removed.
+// Throws std::runtime_error.
+class atomic_file_writer {
+public:
+    explicit atomic_file_writer(const std::filesystem::path &filename, size_t buffer_size = 64 * 1024);
+    ~atomic_file_writer();
+
+    atomic_file_writer(const atomic_file_writer &) = delete;
+    atomic_file_writer &operator = (const atomic_file_writer &) = delete;
+
+    // data can be appended here directly, followed by a call to flush_if_full
+    std::string &buffer() {
+        return m_buffer;
+    }
+
+    void write(std::string_view data) {
+        m_buffer.append(data);
+        flush_if_full();
+    }
+
+    void flush_if_full() {
+        if (m_buffer.size() >= m_buffer_size) flush();
+    }
+
+    void flush();
+    void commit();
+
+private:
+    std::filesystem::path m_filename;
+    std::filesystem::path m_tmp_filename;
+    FILE *m_file = nullptr;
+    std::string m_buffer;
+    size_t m_buffer_size;
+};
+
+#endif
\ No newline at end of file
@@ -0,0 +1,27 @@
+#include "image_convert.h"
+
+#include <cstring>
+
+void rgb_to_gray(const uint8_t *rgb, uint8_t *gray, size_t num_pixels) {
+    for (size_t i = 0; i < num_pixels; ++i) {
+        const uint8_t *px = rgb + i * 3;
+        gray[i] = uint8_t((77 * px[0] + 150 * px[1] + 29 * px[2]) >> 8);
+    }
+}
+
+page_raster to_grayscale(const page_raster &src) {
+    page_raster dst(src.width(), src.height(), 1);
+    size_t num_pixels = size_t(src.width()) * src.height();
+    if (src.channels() == 1) {
+        memcpy(dst.data(), src.data(), num_pixels);
+    } else if (src.channels() == 3) {
+        rgb_to_gray(src.data(), dst.data(), num_pixels);
+    } else {
+        const uint8_t *in = src.data();
+        uint8_t *out = dst.data();
+        for (size_t i = 0; i < num_pixels; ++i, in += src.channels()) {
+            out[i] = uint8_t((77 * in[0] + 150 * in[1] + 29 * in[2]) >> 8);
+        }
+    }
+    return dst;
+}
\ No newline at end of file
@@ -0,0 +1,12 @@
+#ifndef __IMAGE_CONVERT_H__
+#define __IMAGE_CONVERT_H__
+
+#include "page_raster.h"
+
+// Converts interleaved RGB pixels to 8 bit luma
+void rgb_to_gray(const uint8_t *rgb, uint8_t *gray, size_t num_pixels);
+
+// Returns a single channel copy of a color raster, allocated from the buffer pool
+page_raster to_grayscale(const page_raster &src);
+
+#endif
\ No newline at end of file
@@ -1,42 +1,138 @@
 #include "image_panel.h"
 
-#include "pdf_document.h"
+#include "image_scale.h"
+#include "trace.h"
+#include "perf_counters.h"
 
 #include <wx/dcbuffer.h>
+#include <wx/dcmemory.h>
+#include <wx/rawbmp.h>
+
+#include <cstring>
 
 constexpr int SCROLL_RATE = 20;
+constexpr int BITMAP_SIZE_STEP = 256;
 
 wxImagePanel::wxImagePanel(wxWindow *parent) : wxScrolledCanvas(parent) {
     SetScrollRate(SCROLL_RATE, SCROLL_RATE);
     SetBackgroundStyle(wxBG_STYLE_PAINT);
 }
 
-void wxImagePanel::setImage(const wxImage &new_image) {
-    raw_image = new_image;
+wxImagePanel::~wxImagePanel() {
+    setScaledImage(wxBitmap());
+}
+
+// the bitmap is allocated in size steps and reused while the page fits in it,
+// so that flipping pages and zooming do not reallocate it every time
+static int round_up_size(int value) {
+    return (value + BITMAP_SIZE_STEP - 1) / BITMAP_SIZE_STEP * BITMAP_SIZE_STEP;
+}
+
+void wxImagePanel::setScaledImage(wxBitmap bitmap) {
+    int64_t bytes = bitmap.IsOk() ? int64_t(bitmap.GetWidth()) * bitmap.GetHeight() * 3 : 0;
+    perf_counters::get().scaled_bitmap_bytes += bytes - m_scaled_bytes;
+    m_scaled_bytes = bytes;
+    scaled_image = std::move(bitmap);
+}
+
+void wxImagePanel::trimScaledImage() {
+    if (scaled_image.IsOk() && (scaled_image.GetWidth() > round_up_size(m_scaled_size.GetWidth())
+        || scaled_image.GetHeight() > round_up_size(m_scaled_size.GetHeight())))
+    {
+        setScaledImage(wxBitmap());
+        rescale(m_scale, wxIMAGE_QUALITY_HIGH);
+    }
+}
+
+void wxImagePanel::setImage(std::shared_ptr<const page_raster> new_image) {
+    raw_image = std::move(new_image);
+    if (raw_image) {
+        m_page_size = wxSize(raw_image->width(), raw_image->height());
+        m_ink.compute(raw_image->data(), raw_image->width(), raw_image->height(), raw_image->channels());
+    } else {
+        m_ink.clear();
+    }
     rescale(m_scale, wxIMAGE_QUALITY_HIGH);
 }
 
+void wxImagePanel::setPreview(std::shared_ptr<const page_raster> preview) {
+    raw_image = std::move(preview);
+    m_ink.clear();
+    if (raw_image) {
+        int width = m_page_size.GetWidth() > 0 ? m_page_size.GetWidth() : raw_image->width();
+        m_page_size = wxSize(width, width * raw_image->height() / raw_image->width());
+    }
+    rescale(m_scale);
+}
+
+void wxImagePanel::setBlank() {
+    page_raster blank(1, 1, 3);
+    memset(blank.data(), 0xff, blank.size_bytes());
+    raw_image = std::make_shared<const page_raster>(std::move(blank));
+    m_ink.clear();
+    if (m_page_size.GetWidth() <= 0) {
+        m_page_size = wxSize(1, 1);
+    }
+    rescale(m_scale);
+}
+
 void wxImagePanel::rescale(float factor, wxImageResizeQuality quality) {
+    TRACE_SCOPE("rescale");
+    perf_timer timer(perf_counters::get().last_scale_us);
     m_scale = factor;
-    if (raw_image.IsOk()) {
-        scaled_image = raw_image.Scale(
-            raw_image.GetWidth() * m_scale,
-            raw_image.GetHeight() * m_scale, quality);
-        SetVirtualSize(scaled_image.GetSize());
+    if (raw_image) {
+        int width = std::max(1, int(m_page_size.GetWidth() * m_scale));
+        int height = std::max(1, int(m_page_size.GetHeight() * m_scale));
+
+        if (!scaled_image.IsOk() || scaled_image.GetWidth() < width || scaled_image.GetHeight() < height
+            || scaled_image.GetWidth() * scaled_image.GetHeight() > 4 * round_up_size(width) * round_up_size(height)) {
+            setScaledImage(wxBitmap(round_up_size(width), round_up_size(height), 24));
+        }
+        m_scaled_size = wxSize(width, height);
+
+        {
+            wxNativePixelData data(scaled_image);
+            if (!data) return;
+
+            pixel_layout layout {
+                wxNativePixelFormat::SizePixel,
+                wxNativePixelFormat::RED,
+                wxNativePixelFormat::GREEN,
+                wxNativePixelFormat::BLUE
+            };
+            wxNativePixelData::Iterator it(data);
+            scale_raster(raw_image->data(), raw_image->width(), raw_image->height(), raw_image->channels(),
+                reinterpret_cast<uint8_t *>(it.m_ptr), width, height, data.GetRowStride(),
+                layout, quality != wxIMAGE_QUALITY_NORMAL);
+        }
+
+        SetVirtualSize(m_scaled_size);
         Refresh();
     }
 }
 
 void wxImagePanel::render(wxDC &dc) {
-    dc.DrawBitmap(scaled_image, 0, 0);
+    wxRect area = m_dirty_rect.Intersect(wxRect(m_scaled_size));
+    if (!area.IsEmpty()) {
+        wxMemoryDC source(scaled_image);
+        dc.Blit(area.GetPosition(), area.GetSize(), &source, area.GetPosition());
+    }
 }
 
 void wxImagePanel::OnDraw(wxDC &dc) {
+    TRACE_SCOPE("OnDraw");
+    perf_timer timer(perf_counters::get().last_paint_us);
     if (scaled_image.IsOk()) {
         wxBufferedDC buf_dc(&dc, wxSize(
-            std::max(scaled_image.GetWidth(), GetSize().GetWidth()),
-            std::max(scaled_image.GetHeight(), GetSize().GetHeight())
+            std::max(m_scaled_size.GetWidth(), GetSize().GetWidth()),
+            std::max(m_scaled_size.GetHeight(), GetSize().GetHeight())
         ), wxBUFFER_VIRTUAL_AREA);
+
+        // only the invalidated part of the page is drawn again
+        m_dirty_rect = GetUpdateRegion().GetBox();
+        m_dirty_rect.SetPosition(CalcUnscrolledPosition(m_dirty_rect.GetPosition()));
+        buf_dc.SetClippingRegion(m_dirty_rect);
+
         buf_dc.Clear();
         render(buf_dc);
     }
@@ -5,33 +5,60 @@
 #include <wx/scrolwin.h>
 #include <wx/bitmap.h>
 
+#include <memory>
+
+#include "page_raster.h"
+#include "ink_projection.h"
+
 class wxImagePanel : public wxScrolledCanvas {
 public:
     wxImagePanel(wxWindow *parent);
+    ~wxImagePanel();
+
+    void setImage(std::shared_ptr<const page_raster> new_image);
 
-    void setImage(const wxImage &new_image);
+    // shows a low resolution stand-in at the size of the last page, until the real page is set
+    void setPreview(std::shared_ptr<const page_raster> preview);
+
+    // shows a blank page at the size of the last page, until the real page is set
+    void setBlank();
 
     void rescale(float factor, wxImageResizeQuality quality = wxIMAGE_QUALITY_NORMAL);
 
+    // reallocates the zoomed page if its bitmap is much larger than needed
+    void trimScaledImage();
+
     double scaled_width() {
-        return scaled_image.IsOk() ? scaled_image.GetWidth() : 1;
+        return scaled_image.IsOk() ? m_scaled_size.GetWidth() : 1;
     }
 
     double scaled_height() {
-        return scaled_image.IsOk() ? scaled_image.GetHeight() : 1;
+        return scaled_image.IsOk() ? m_scaled_size.GetHeight() : 1;
     }
 
 protected:
     float m_scale = 0.5f;
 
 protected:
-    wxImage raw_image;
+    std::shared_ptr<const page_raster> raw_image;
     wxBitmap scaled_image;
+    wxSize m_scaled_size;
+    wxSize m_page_size;
+
+    ink_projection m_ink;
+
+    // the part of the page being repainted, in unscrolled coordinates
+    wxRect m_dirty_rect;
     
     virtual void render(wxDC &dc);
 
 private:
+    void setScaledImage(wxBitmap bitmap);
+
     virtual void OnDraw(wxDC &dc) override;
+
+private:
+    int64_t m_scaled_bytes = 0;
 };
 
 #endif
\ No newline at end of file
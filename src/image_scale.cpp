@@ -0,0 +1,101 @@
+#include "image_scale.h"
+
+#include <vector>
+#include <algorithm>
+
+struct sample_span {
+    int begin, end;
+};
+
+static std::vector<sample_span> make_spans(int src_size, int dst_size) {
+    std::vector<sample_span> spans(dst_size);
+    for (int i = 0; i < dst_size; ++i) {
+        int begin = int(int64_t(i) * src_size / dst_size);
+        int end = int(int64_t(i + 1) * src_size / dst_size);
+        spans[i] = {std::min(begin, src_size - 1), std::clamp(end, begin + 1, src_size)};
+    }
+    return spans;
+}
+
+static inline void write_pixel(uint8_t *out, const pixel_layout &layout, const uint32_t *value, int channels) {
+    if (channels == 1) {
+        out[layout.red] = out[layout.green] = out[layout.blue] = uint8_t(value[0]);
+    } else {
+        out[layout.red] = uint8_t(value[0]);
+        out[layout.green] = uint8_t(value[1]);
+        out[layout.blue] = uint8_t(value[2]);
+    }
+}
+
+static void scale_nearest(
+    const uint8_t *src, int src_width, int src_height, int channels,
+    uint8_t *dst, int dst_width, int dst_height, ptrdiff_t dst_stride, const pixel_layout &layout)
+{
+    std::vector<size_t> offsets(dst_width);
+    for (int x = 0; x < dst_width; ++x) {
+        offsets[x] = size_t(int64_t(x) * src_width / dst_width) * channels;
+    }
+    for (int y = 0; y < dst_height; ++y) {
+        const uint8_t *src_row = src + size_t(int64_t(y) * src_height / dst_height) * src_width * channels;
+        uint8_t *out = dst + y * dst_stride;
+        for (int x = 0; x < dst_width; ++x, out += layout.bytes_per_pixel) {
+            const uint8_t *px = src_row + offsets[x];
+            uint32_t value[3] = {px[0], channels == 1 ? 0u : px[1], channels == 1 ? 0u : px[2]};
+            write_pixel(out, layout, value, channels);
+        }
+    }
+}
+
+static void scale_area(
+    const uint8_t *src, int src_width, int src_height, int channels,
+    uint8_t *dst, int dst_width, int dst_height, ptrdiff_t dst_stride, const pixel_layout &layout)
+{
+    const size_t src_stride = size_t(src_width) * channels;
+    auto xspans = make_spans(src_width, dst_width);
+    auto yspans = make_spans(src_height, dst_height);
+
+    // sum of the source rows covered by one destination row
+    std::vector<uint32_t> column_sums(src_stride);
+
+    for (int y = 0; y < dst_height; ++y) {
+        auto [y0, y1] = yspans[y];
+        std::fill(column_sums.begin(), column_sums.end(), 0);
+        uint32_t *sums = column_sums.data();
+        for (int sy = y0; sy < y1; ++sy) {
+            const uint8_t *src_row = src + size_t(sy) * src_stride;
+            for (size_t i = 0; i < src_stride; ++i) {
+                sums[i] += src_row[i];
+            }
+        }
+
+        uint8_t *out = dst + y * dst_stride;
+        for (int x = 0; x < dst_width; ++x, out += layout.bytes_per_pixel) {
+            auto [x0, x1] = xspans[x];
+            uint32_t count = uint32_t(x1 - x0) * (y1 - y0);
+            uint32_t value[3] = {0, 0, 0};
+            for (int sx = x0; sx < x1; ++sx) {
+                for (int c = 0; c < channels; ++c) {
+                    value[c] += sums[sx * channels + c];
+                }
+            }
+            for (int c = 0; c < channels; ++c) {
+                value[c] = (value[c] + count / 2) / count;
+            }
+            write_pixel(out, layout, value, channels);
+        }
+    }
+}
+
+void scale_raster(
+    const uint8_t *src, int src_width, int src_height, int src_channels,
+    uint8_t *dst, int dst_width, int dst_height, ptrdiff_t dst_stride,
+    const pixel_layout &layout, bool high_quality)
+{
+    if (dst_width <= 0 || dst_height <= 0 || src_width <= 0 || src_height <= 0) return;
+
+    if (high_quality && dst_width < src_width && dst_height < src_height) {
+        scale_area(src, src_width, src_height, src_channels, dst, dst_width, dst_height, dst_stride, layout);
+    } else {
+        scale_nearest(src, src_width, src_height, src_channels, dst, dst_width, dst_height, dst_stride, layout);
+    }
+}
\ No newline at end of file
@@ -0,0 +1,22 @@
+#ifndef __IMAGE_SCALE_H__
+#define __IMAGE_SCALE_H__
+
+#include <cstdint>
+#include <cstddef>
+
+// Layout of the destination pixels, so that the kernels can write straight into native bitmap memory
+struct pixel_layout {
+    int bytes_per_pixel = 3;
+    int red = 0;
+    int green = 1;
+    int blue = 2;
+};
+
+// Resamples an interleaved raster with 1 (gray) or 3 (RGB) channels into dst.
+// Uses nearest neighbour sampling, or area averaging when high_quality is set.
+void scale_raster(
+    const uint8_t *src, int src_width, int src_height, int src_channels,
+    uint8_t *dst, int dst_width, int dst_height, ptrdiff_t dst_stride,
+    const pixel_layout &layout, bool high_quality);
+
+#endif
\ No newline at end of file
@@ -0,0 +1,210 @@
+#include "ink_projection.h"
+
+#include <algorithm>
+
+#if defined(__SSE2__) || defined(_M_X64)
+    #include <emmintrin.h>
+    #define INK_PROJECTION_SSE2
+#endif
+
+constexpr uint8_t INK_THRESHOLD = 160;
+constexpr int MAX_XY_CUT_DEPTH = 12;
+
+// writes 1 for every dark pixel of a single channel row, returns the number of dark pixels
+static uint32_t threshold_gray_row(const uint8_t *src, uint8_t *mask, int width) {
+    int x = 0;
+    uint32_t count = 0;
+#ifdef INK_PROJECTION_SSE2
+    const __m128i sign = _mm_set1_epi8(char(0x80));
+    const __m128i threshold = _mm_set1_epi8(char(INK_THRESHOLD ^ 0x80));
+    const __m128i one = _mm_set1_epi8(1);
+    __m128i sum = _mm_setzero_si128();
+    for (; x + 16 <= width; x += 16) {
+        __m128i value = _mm_xor_si128(_mm_loadu_si128(reinterpret_cast<const __m128i *>(src + x)), sign);
+        __m128i dark = _mm_and_si128(_mm_cmplt_epi8(value, threshold), one);
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(mask + x), dark);
+        sum = _mm_add_epi64(sum, _mm_sad_epu8(dark, _mm_setzero_si128()));
+    }
+    count = _mm_cvtsi128_si32(sum) + _mm_cvtsi128_si32(_mm_srli_si128(sum, 8));
+#endif
+    for (; x < width; ++x) {
+        mask[x] = src[x] < INK_THRESHOLD;
+        count += mask[x];
+    }
+    return count;
+}
+
+// same as above for interleaved color rows, using an integer approximation of luma
+static uint32_t threshold_color_row(const uint8_t *src, uint8_t *mask, int width, int channels) {
+    uint32_t count = 0;
+    for (int x = 0; x < width; ++x) {
+        const uint8_t *px = src + x * channels;
+        uint32_t luma = (77 * px[0] + 150 * px[1] + 29 * px[2]) >> 8;
+        mask[x] = luma < INK_THRESHOLD;
+        count += mask[x];
+    }
+    return count;
+}
+
+void ink_projection::compute(const uint8_t *pixels, int width, int height, int channels) {
+    m_width = width;
+    m_height = height;
+
+    m_mask.resize(size_t(width) * height);
+    m_rows.assign(height, 0);
+    m_cols.assign(width, 0);
+
+    for (int y = 0; y < height; ++y) {
+        const uint8_t *src = pixels + size_t(y) * width * channels;
+        uint8_t *mask = m_mask.data() + size_t(y) * width;
+        if (channels == 1) {
+            m_rows[y] = threshold_gray_row(src, mask, width);
+        } else {
+            m_rows[y] = threshold_color_row(src, mask, width, channels);
+        }
+        if (m_rows[y] != 0) {
+            uint32_t *cols = m_cols.data();
+            for (int x = 0; x < width; ++x) {
+                cols[x] += mask[x];
+            }
+        }
+    }
+
+    find_edges();
+}
+
+void ink_projection::clear() {
+    m_width = m_height = 0;
+    m_mask.clear();
+    m_rows.clear();
+    m_cols.clear();
+    m_edges_x.clear();
+    m_edges_y.clear();
+}
+
+// edges are the boundaries between empty and inked bands, plus the long rules of tables
+static void find_profile_edges(std::vector<int> &edges, const std::vector<uint32_t> &profile, uint32_t noise, uint32_t rule) {
+    edges.clear();
+    bool was_ink = false;
+    for (size_t i = 0; i < profile.size(); ++i) {
+        bool is_ink = profile[i] > noise;
+        if (is_ink != was_ink) {
+            edges.push_back(int(i));
+        } else if (profile[i] > rule && (i == 0 || profile[i - 1] <= rule)) {
+            edges.push_back(int(i));
+        }
+        was_ink = is_ink;
+    }
+    if (was_ink) {
+        edges.push_back(int(profile.size()));
+    }
+}
+
+void ink_projection::find_edges() {
+    find_profile_edges(m_edges_x, m_cols, std::max(1, m_height / 500), m_height / 2);
+    find_profile_edges(m_edges_y, m_rows, std::max(1, m_width / 500), m_width / 2);
+}
+
+static int snap_to_edges(const std::vector<int> &edges, int value, int tolerance) {
+    auto it = std::ranges::lower_bound(edges, value);
+    int best = -1;
+    int best_dist = tolerance + 1;
+    if (it != edges.end() && *it - value < best_dist) {
+        best = *it;
+        best_dist = *it - value;
+    }
+    if (it != edges.begin() && value - *std::prev(it) < best_dist) {
+        best = *std::prev(it);
+    }
+    return best;
+}
+
+int ink_projection::snap_x(int x, int tolerance) const {
+    return snap_to_edges(m_edges_x, x, tolerance);
+}
+
+int ink_projection::snap_y(int y, int tolerance) const {
+    return snap_to_edges(m_edges_y, y, tolerance);
+}
+
+std::vector<ink_block> ink_projection::suggest_blocks(int min_gap, int min_size) const {
+    std::vector<ink_block> ret;
+    if (!empty()) {
+        xy_cut(ret, 0, 0, m_width, m_height, min_gap, min_size, 0);
+    }
+    return ret;
+}
+
+struct profile_gap {
+    int begin = 0, end = 0;
+    int ink_begin = 0, ink_end = 0;
+
+    int width() const { return end - begin; }
+};
+
+// finds the widest run of empty lines strictly inside the inked range of a profile,
+// lines with no more than noise dark pixels are considered empty
+static profile_gap find_widest_gap(const std::vector<uint32_t> &profile, uint32_t noise) {
+    profile_gap gap;
+    int n = int(profile.size());
+    while (gap.ink_begin < n && profile[gap.ink_begin] <= noise) ++gap.ink_begin;
+    gap.ink_end = n;
+    while (gap.ink_end > gap.ink_begin && profile[gap.ink_end - 1] <= noise) --gap.ink_end;
+
+    for (int i = gap.ink_begin; i < gap.ink_end;) {
+        if (profile[i] <= noise) {
+            int j = i;
+            while (j < gap.ink_end && profile[j] <= noise) ++j;
+            if (j - i > gap.width()) {
+                gap.begin = i;
+                gap.end = j;
+            }
+            i = j;
+        } else {
+            ++i;
+        }
+    }
+    return gap;
+}
+
+void ink_projection::xy_cut(std::vector<ink_block> &out, int x0, int y0, int x1, int y1, int min_gap, int min_size, int depth) const {
+    std::vector<uint32_t> rows(y1 - y0, 0);
+    std::vector<uint32_t> cols(x1 - x0, 0);
+    for (int y = y0; y < y1; ++y) {
+        const uint8_t *mask = m_mask.data() + size_t(y) * m_width + x0;
+        uint32_t *pcols = cols.data();
+        uint32_t count = 0;
+        for (int x = 0; x < x1 - x0; ++x) {
+            pcols[x] += mask[x];
+            count += mask[x];
+        }
+        rows[y - y0] = count;
+    }
+
+    profile_gap row_gap = find_widest_gap(rows, (x1 - x0) / 500);
+    profile_gap col_gap = find_widest_gap(cols, (y1 - y0) / 500);
+    if (row_gap.ink_begin >= row_gap.ink_end || col_gap.ink_begin >= col_gap.ink_end) {
+        return;
+    }
+
+    if (depth < MAX_XY_CUT_DEPTH) {
+        if (row_gap.width() >= min_gap && row_gap.width() >= col_gap.width()) {
+            xy_cut(out, x0, y0 + row_gap.ink_begin, x1, y0 + row_gap.begin, min_gap, min_size, depth + 1);
+            xy_cut(out, x0, y0 + row_gap.end, x1, y0 + row_gap.ink_end, min_gap, min_size, depth + 1);
+            return;
+        }
+        if (col_gap.width() >= min_gap) {
+            xy_cut(out, x0 + col_gap.ink_begin, y0, x0 + col_gap.begin, y1, min_gap, min_size, depth + 1);
+            xy_cut(out, x0 + col_gap.end, y0, x0 + col_gap.ink_end, y1, min_gap, min_size, depth + 1);
+            return;
+        }
+    }
+
+    ink_block block {
+        x0 + col_gap.ink_begin, y0 + row_gap.ink_begin,
+        col_gap.ink_end - col_gap.ink_begin, row_gap.ink_end - row_gap.ink_begin
+    };
+    if (block.w >= min_size && block.h >= min_size) {
+        out.push_back(block);
+    }
+}
\ No newline at end of file
@@ -0,0 +1,52 @@
+#ifndef __INK_PROJECTION_H__
+#define __INK_PROJECTION_H__
+
+#include <vector>
+#include <cstdint>
+
+struct ink_block {
+    int x, y, w, h;
+};
+
+// Row and column projections of the dark pixels of a page raster.
+// Used to snap box edges to gutters, rules and text blocks
+// and to suggest boxes on scanned pages without a text layer.
+class ink_projection {
+public:
+    void compute(const uint8_t *pixels, int width, int height, int channels);
+    void clear();
+
+    bool empty() const {
+        return m_width == 0 || m_height == 0;
+    }
+
+    int width() const { return m_width; }
+    int height() const { return m_height; }
+
+    const std::vector<uint32_t> &rows() const { return m_rows; }
+    const std::vector<uint32_t> &cols() const { return m_cols; }
+
+    // returns the nearest edge within tolerance pixels, or -1
+    int snap_x(int x, int tolerance) const;
+    int snap_y(int y, int tolerance) const;
+
+    // recursive XY-cut along empty gutters at least min_gap pixels wide
+    std::vector<ink_block> suggest_blocks(int min_gap, int min_size) const;
+
+private:
+    void find_edges();
+    void xy_cut(std::vector<ink_block> &out, int x0, int y0, int x1, int y1, int min_gap, int min_size, int depth) const;
+
+private:
+    int m_width = 0;
+    int m_height = 0;
+
+    std::vector<uint8_t> m_mask;
+    std::vector<uint32_t> m_rows;
+    std::vector<uint32_t> m_cols;
+
+    std::vector<int> m_edges_x;
+    std::vector<int> m_edges_y;
+};
+
+#endif
\ No newline at end of file
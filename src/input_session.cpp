@@ -0,0 +1,117 @@
+#include "input_session.h"
+
+#include <format>
+#include <cmath>
+#include <climits>
+#include <limits>
+#include <stdexcept>
+
+#include "json_utils.h"
+
+constexpr int INPUT_SESSION_VERSION = 1;
+
+static constexpr const char *event_names[] = {
+    "page_select", "scale_change", "scale_final", "tool_change", "mouse_down", "mouse_move", "mouse_up"
+};
+
+const char *input_event_name(input_event_type type) {
+    return event_names[static_cast<int>(type)];
+}
+
+static input_event_type parse_event_type(std::string_view name) {
+    for (size_t i = 0; i < std::size(event_names); ++i) {
+        if (name == event_names[i]) return static_cast<input_event_type>(i);
+    }
+    throw std::out_of_range("Invalid data");
+}
+
+// numbers of the file are checked before they are converted, out of range values are malformed
+static int64_t to_integer(double number, int64_t min_value, int64_t max_value) {
+    if (!(number >= double(min_value) && number <= double(max_value)) || number != std::floor(number)) {
+        throw std::out_of_range("Invalid data");
+    }
+    return int64_t(number);
+}
+
+static float to_float(double number) {
+    if (!std::isfinite(number) || std::abs(number) > std::numeric_limits<float>::max()) {
+        throw std::out_of_range("Invalid data");
+    }
+    return float(number);
+}
+
+input_session input_session::load(const std::filesystem::path &filename) {
+    std::ifstream stream(filename);
+    if (!stream) {
+        throw std::out_of_range("Invalid data");
+    }
+
+    input_session ret;
+    std::string line;
+    if (!std::getline(stream, line)) {
+        throw std::out_of_range("Invalid data");
+    }
+    json_value header = json_value::parse(line);
+    if (header["version"].as_number() != INPUT_SESSION_VERSION) {
+        throw std::out_of_range("Invalid data");
+    }
+    ret.layout_filename = header["layout"].as_string();
+    ret.pdf_filename = header["pdf"].as_string();
+
+    while (std::getline(stream, line)) {
+        if (line.empty()) continue;
+        json_value obj = json_value::parse(line);
+        input_event &event = ret.events.emplace_back();
+        event.type = parse_event_type(obj["type"].as_string());
+        // 2^53, the largest integer a double holds exactly
+        event.time_us = to_integer(obj["t"].as_number(), 0, int64_t(1) << 53);
+        if (obj.contains("value")) event.value = int(to_integer(obj["value"].as_number(), INT_MIN, INT_MAX));
+        if (obj.contains("x")) event.x = to_float(obj["x"].as_number());
+        if (obj.contains("y")) event.y = to_float(obj["y"].as_number());
+        if (obj.contains("mods")) event.modifiers = int(to_integer(obj["mods"].as_number(), INT_MIN, INT_MAX));
+    }
+    return ret;
+}
+
+input_recorder &input_recorder::get() {
+    static input_recorder recorder;
+    return recorder;
+}
+
+bool input_recorder::start(const std::filesystem::path &filename, const std::filesystem::path &layout_filename, const std::filesystem::path &pdf_filename) {
+    stop();
+    m_stream.open(filename, std::ios::out | std::ios::trunc);
+    if (!m_stream) return false;
+
+    m_start = std::chrono::steady_clock::now();
+    m_line = std::format("{{\"version\":{},\"layout\":", INPUT_SESSION_VERSION);
+    append_json_string(m_line, layout_filename.string());
+    m_line += ",\"pdf\":";
+    append_json_string(m_line, pdf_filename.string());
+    m_line += "}\n";
+    m_stream << m_line;
+    return true;
+}
+
+void input_recorder::stop() {
+    if (m_stream.is_open()) {
+        m_stream.close();
+    }
+}
+
+void input_recorder::record(input_event_type type, int value, float x, float y, int modifiers) {
+    if (!recording()) return;
+
+    auto time_us = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - m_start).count();
+    m_line = std::format("{{\"t\":{},\"type\":\"{}\"", time_us, input_event_name(type));
+    switch (type) {
+    case input_event_type::mouse_down:
+    case input_event_type::mouse_move:
+    case input_event_type::mouse_up:
+        m_line += std::format(",\"x\":{},\"y\":{},\"mods\":{}}}\n", x, y, modifiers);
+        break;
+    default:
+        m_line += std::format(",\"value\":{}}}\n", value);
+    }
+    m_stream << m_line;
+}
\ No newline at end of file
@@ -0,0 +1,67 @@
+#ifndef __INPUT_SESSION_H__
+#define __INPUT_SESSION_H__
+
+#include <filesystem>
+#include <fstream>
+#include <chrono>
+#include <string>
+#include <vector>
+
+enum class input_event_type {
+    page_select,    // value is the page
+    scale_change,   // value is the slider position while dragging
+    scale_final,    // value is the slider position once released
+    tool_change,    // value is the tool id
+    mouse_down,
+    mouse_move,
+    mouse_up,
+};
+
+// Mouse positions are in page coordinates, so that a session replays the same way
+// whatever the size of the window and the zoom of the replay.
+struct input_event {
+    input_event_type type;
+    int64_t time_us = 0;
+    int value = 0;
+    float x = 0.f;
+    float y = 0.f;
+    int modifiers = 0;
+};
+
+struct input_session {
+    std::filesystem::path layout_filename;
+    std::filesystem::path pdf_filename;
+    std::vector<input_event> events;
+
+    // reads a session written by input_recorder, throws std::out_of_range on malformed files
+    static input_session load(const std::filesystem::path &filename);
+};
+
+const char *input_event_name(input_event_type type);
+
+// Writes the input events of the editor to a JSON lines file:
+// a header with the layout and PDF that were open, then one line per event.
+// The recording stops when another layout or PDF is opened.
+class input_recorder {
+public:
+    static input_recorder &get();
+
+    bool start(const std::filesystem::path &filename, const std::filesystem::path &layout_filename, const std::filesystem::path &pdf_filename);
+    void stop();
+
+    bool recording() const {
+        return m_stream.is_open();
+    }
+
+    void record(input_event_type type, int value, float x = 0.f, float y = 0.f, int modifiers = 0);
+
+private:
+    input_recorder() = default;
+
+private:
+    std::ofstream m_stream;
+    std::chrono::steady_clock::time_point m_start;
+    std::string m_line;
+};
+
+#endif
\ No newline at end of file
@@ -0,0 +1,225 @@
+#include "json_utils.h"
+
+#include <charconv>
+#include <cctype>
+#include <format>
+#include <stdexcept>
+
+void append_json_string(std::string &out, std::string_view str) {
+    out += '"';
+    for (char c : str) {
+        switch (c) {
+        case '"':  out += "\\\""; break;
+        case '\\': out += "\\\\"; break;
+        case '\n': out += "\\n"; break;
+        case '\r': out += "\\r"; break;
+        case '\t': out += "\\t"; break;
+        default:
+            if (uint8_t(c) < 0x20) {
+                out += std::format("\\u{:04x}", int(c));
+            } else {
+                out += c;
+            }
+        }
+    }
+    out += '"';
+}
+
+const json_value &json_value::operator[](std::string_view key) const {
+    const auto &obj = std::get<object>(value);
+    auto it = obj.find(key);
+    if (it == obj.end()) throw std::out_of_range("Invalid data");
+    return it->second;
+}
+
+bool json_value::contains(std::string_view key) const {
+    return is_object() && std::get<object>(value).contains(key);
+}
+
+template<typename T>
+static const T &get_as(const auto &value) {
+    if (!std::holds_alternative<T>(value)) throw std::out_of_range("Invalid data");
+    return std::get<T>(value);
+}
+
+const json_value::array &json_value::as_array() const {
+    return get_as<array>(value);
+}
+
+const json_value::object &json_value::as_object() const {
+    return get_as<object>(value);
+}
+
+const std::string &json_value::as_string() const {
+    return get_as<std::string>(value);
+}
+
+double json_value::as_number() const {
+    return get_as<double>(value);
+}
+
+bool json_value::as_bool() const {
+    return get_as<bool>(value);
+}
+
+namespace {
+    constexpr int MAX_JSON_DEPTH = 64;
+
+    struct json_parser {
+        std::string_view str;
+        size_t pos = 0;
+
+        [[noreturn]] void error() {
+            throw std::out_of_range("Invalid data");
+        }
+
+        void skip_whitespace() {
+            while (pos < str.size() && (str[pos] == ' ' || str[pos] == '\t' || str[pos] == '\n' || str[pos] == '\r')) ++pos;
+        }
+
+        char peek() {
+            skip_whitespace();
+            if (pos >= str.size()) error();
+            return str[pos];
+        }
+
+        void expect(char c) {
+            if (peek() != c) error();
+            ++pos;
+        }
+
+        bool consume(std::string_view word) {
+            if (str.substr(pos, word.size()) != word) return false;
+            pos += word.size();
+            return true;
+        }
+
+        static void append_utf8(std::string &out, uint32_t cp) {
+            if (cp < 0x80) {
+                out += char(cp);
+            } else if (cp < 0x800) {
+                out += char(0xc0 | (cp >> 6));
+                out += char(0x80 | (cp & 0x3f));
+            } else if (cp < 0x10000) {
+                out += char(0xe0 | (cp >> 12));
+                out += char(0x80 | ((cp >> 6) & 0x3f));
+                out += char(0x80 | (cp & 0x3f));
+            } else {
+                out += char(0xf0 | (cp >> 18));
+                out += char(0x80 | ((cp >> 12) & 0x3f));
+                out += char(0x80 | ((cp >> 6) & 0x3f));
+                out += char(0x80 | (cp & 0x3f));
+            }
+        }
+
+        uint32_t parse_hex4() {
+            if (pos + 4 > str.size()) error();
+            uint32_t cp;
+            auto [ptr, ec] = std::from_chars(str.data() + pos, str.data() + pos + 4, cp, 16);
+            if (ec != std::errc() || ptr != str.data() + pos + 4) error();
+            pos += 4;
+            return cp;
+        }
+
+        std::string parse_string() {
+            expect('"');
+            std::string ret;
+            while (true) {
+                if (pos >= str.size()) error();
+                char c = str[pos++];
+                if (c == '"') break;
+                if (c != '\\') {
+                    ret += c;
+                    continue;
+                }
+                if (pos >= str.size()) error();
+                switch (str[pos++]) {
+                case '"':  ret += '"'; break;
+                case '\\': ret += '\\'; break;
+                case '/':  ret += '/'; break;
+                case 'b':  ret += '\b'; break;
+                case 'f':  ret += '\f'; break;
+                case 'n':  ret += '\n'; break;
+                case 'r':  ret += '\r'; break;
+                case 't':  ret += '\t'; break;
+                case 'u': {
+                    uint32_t cp = parse_hex4();
+                    if (cp >= 0xd800 && cp < 0xdc00 && consume("\\u")) {
+                        uint32_t low = parse_hex4();
+                        cp = 0x10000 + ((cp - 0xd800) << 10) + (low - 0xdc00);
+                    }
+                    append_utf8(ret, cp);
+                    break;
+                }
+                default:
+                    error();
+                }
+            }
+            return ret;
+        }
+
+        double parse_number() {
+            size_t begin = pos;
+            while (pos < str.size() && (isdigit(uint8_t(str[pos])) || str[pos] == '-' || str[pos] == '+' || str[pos] == '.' || str[pos] == 'e' || str[pos] == 'E')) ++pos;
+            double ret;
+            auto [ptr, ec] = std::from_chars(str.data() + begin, str.data() + pos, ret);
+            if (ec != std::errc() || ptr != str.data() + pos) error();
+            return ret;
+        }
+
+        json_value parse_value(int depth) {
+            if (depth > MAX_JSON_DEPTH) error();
+            json_value ret;
+            switch (peek()) {
+            case '{': {
+                ++pos;
+                json_value::object obj;
+                if (peek() != '}') {
+                    do {
+                        std::string key = parse_string();
+                        expect(':');
+                        obj.insert_or_assign(std::move(key), parse_value(depth + 1));
+                    } while (peek() == ',' && ++pos);
+                }
+                expect('}');
+                ret.value = std::move(obj);
+                break;
+            }
+            case '[': {
+                ++pos;
+                json_value::array arr;
+                if (peek() != ']') {
+                    do {
+                        arr.push_back(parse_value(depth + 1));
+                    } while (peek() == ',' && ++pos);
+                }
+                expect(']');
+                ret.value = std::move(arr);
+                break;
+            }
+            case '"':
+                ret.value = parse_string();
+                break;
+            default:
+                if (consume("true")) {
+                    ret.value = true;
+                } else if (consume("false")) {
+                    ret.value = false;
+                } else if (consume("null")) {
+                    ret.value = nullptr;
+                } else {
+                    ret.value = parse_number();
+                }
+            }
+            return ret;
+        }
+    };
+}
+
+json_value json_value::parse(std::string_view str) {
+    json_parser parser{str};
+    json_value ret = parser.parse_value(0);
+    parser.skip_whitespace();
+    if (parser.pos != str.size()) parser.error();
+    return ret;
+}
\ No newline at end of file
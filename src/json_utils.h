@@ -0,0 +1,37 @@
+#ifndef __JSON_UTILS_H__
+#define __JSON_UTILS_H__
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <map>
+#include <variant>
+
+// Appends str as a quoted and escaped JSON string
+void append_json_string(std::string &out, std::string_view str);
+
+// Minimal JSON document tree, enough to read back what the editor writes
+struct json_value {
+    using array = std::vector<json_value>;
+    using object = std::map<std::string, json_value, std::less<>>;
+
+    std::variant<std::nullptr_t, bool, double, std::string, array, object> value;
+
+    bool is_object() const { return std::holds_alternative<object>(value); }
+    bool is_array() const { return std::holds_alternative<array>(value); }
+
+    // these throw std::out_of_range if the value has a different type or the key is missing
+    const json_value &operator[](std::string_view key) const;
+    const array &as_array() const;
+    const object &as_object() const;
+    const std::string &as_string() const;
+    double as_number() const;
+    bool as_bool() const;
+
+    bool contains(std::string_view key) const;
+
+    // throws std::out_of_range on malformed input
+    static json_value parse(std::string_view str);
+};
+
+#endif
\ No newline at end of file
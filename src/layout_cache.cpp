@@ -0,0 +1,127 @@
+#include "layout_cache.h"
+
+#include <fstream>
+
+#include "layout_serial.h"
+#include "file_hash.h"
+#include "file_utils.h"
+
+constexpr uint32_t LAYOUT_CACHE_MAGIC = 0x43534c42; // "BLSC"
+constexpr uint64_t LAYOUT_CACHE_VERSION = 1;
+
+struct source_stamp {
+    int64_t mtime = 0;
+    uint64_t size = 0;
+};
+
+static bool get_stamp(const std::filesystem::path &filename, source_stamp &stamp) {
+    std::error_code ec;
+    auto mtime = std::filesystem::last_write_time(filename, ec);
+    if (ec) return false;
+    stamp.size = std::filesystem::file_size(filename, ec);
+    if (ec) return false;
+    stamp.mtime = mtime.time_since_epoch().count();
+    return true;
+}
+
+layout_cache &layout_cache::get() {
+    static layout_cache cache;
+    return cache;
+}
+
+void layout_cache::setDirectory(const std::filesystem::path &directory) {
+    std::scoped_lock lock(m_mutex);
+    m_directory = directory;
+}
+
+std::filesystem::path layout_cache::getFilename(const std::filesystem::path &filename) {
+    std::scoped_lock lock(m_mutex);
+    if (m_directory.empty()) return {};
+    std::error_code ec;
+    return m_directory / (hash_to_hex(hash_string(std::filesystem::absolute(filename, ec).string())) + ".bin");
+}
+
+layout_box_list layout_cache::load(const std::filesystem::path &filename) {
+    layout_box_list layout;
+    if (loadCached(filename, layout)) {
+        return layout;
+    }
+
+    layout = layout_box_list(filename);
+    try {
+        store(layout, hash_file(filename));
+    } catch (const std::exception &) {
+        // the cache is only an optimization
+    }
+    return layout;
+}
+
+bool layout_cache::loadCached(const std::filesystem::path &filename, layout_box_list &layout) {
+    auto cache_filename = getFilename(filename);
+    if (cache_filename.empty()) return false;
+
+    source_stamp stamp;
+    if (!get_stamp(filename, stamp)) return false;
+
+    // the whole entry is read at once, strings are the only other allocations
+    std::string data;
+    {
+        std::ifstream ifs(cache_filename, std::ios::binary | std::ios::ate);
+        if (!ifs) return false;
+        data.resize(size_t(ifs.tellg()));
+        ifs.seekg(0);
+        if (!ifs.read(data.data(), data.size())) return false;
+    }
+
+    try {
+        binary_reader reader(data);
+        uint32_t magic;
+        reader.read_bytes(&magic, sizeof(magic));
+        if (magic != LAYOUT_CACHE_MAGIC || reader.read_varint() != LAYOUT_CACHE_VERSION) return false;
+        if (reader.read_signed() != stamp.mtime || reader.read_varint() != stamp.size) return false;
+        if (reader.read_varint() != hash_file(filename)) return false;
+
+        layout.filename = filename;
+        reader.read_options(layout);
+        uint64_t count = reader.read_varint();
+        for (uint64_t i = 0; i < count; ++i) {
+            layout.push_back(reader.read_box());
+        }
+        return reader.at_end();
+    } catch (const std::exception &) {
+        layout = layout_box_list();
+        return false;
+    }
+}
+
+void layout_cache::store(const layout_box_list &layout) {
+    try {
+        store(layout, hash_file(layout.filename));
+    } catch (const std::exception &) {
+        // the cache is only an optimization
+    }
+}
+
+void layout_cache::store(const layout_box_list &layout, uint64_t content_hash) {
+    auto cache_filename = getFilename(layout.filename);
+    if (cache_filename.empty()) return;
+
+    source_stamp stamp;
+    if (!get_stamp(layout.filename, stamp)) return;
+
+    binary_writer writer;
+    writer.write_bytes(&LAYOUT_CACHE_MAGIC, sizeof(LAYOUT_CACHE_MAGIC));
+    writer.write_varint(LAYOUT_CACHE_VERSION);
+    writer.write_signed(stamp.mtime);
+    writer.write_varint(stamp.size);
+    writer.write_varint(content_hash);
+    writer.write_options(layout);
+    writer.write_varint(layout.size());
+    for (const layout_box &box : layout) {
+        writer.write_box(box);
+    }
+
+    std::error_code ec;
+    std::filesystem::create_directories(cache_filename.parent_path(), ec);
+    atomic_write_file(cache_filename, writer.data());
+}
\ No newline at end of file
@@ -0,0 +1,40 @@
+#ifndef __LAYOUT_CACHE_H__
+#define __LAYOUT_CACHE_H__
+
+#include <filesystem>
+#include <mutex>
+
+#include "layout.h"
+
+using namespace bls;
+
+// Binary copies of parsed layout files, keyed by absolute path.
+// An entry is only used if the modification time, size and content hash
+// of the text file still match, otherwise the text file is parsed again.
+class layout_cache {
+public:
+    static layout_cache &get();
+
+    // an empty directory disables the cache
+    void setDirectory(const std::filesystem::path &directory);
+
+    // reads the layout from the cache, or parses the text file and caches it
+    layout_box_list load(const std::filesystem::path &filename);
+
+    // caches a layout that was just written to its file
+    void store(const layout_box_list &layout);
+
+private:
+    layout_cache() = default;
+
+    std::filesystem::path getFilename(const std::filesystem::path &filename);
+
+    bool loadCached(const std::filesystem::path &filename, layout_box_list &layout);
+    void store(const layout_box_list &layout, uint64_t content_hash);
+
+private:
+    std::mutex m_mutex;
+    std::filesystem::path m_directory;
+};
+
+#endif
\ No newline at end of file
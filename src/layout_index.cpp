@@ -0,0 +1,215 @@
+#include "layout_index.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <fstream>
+#include <sstream>
+
+#include "file_utils.h"
+#include "json_utils.h"
+#include "trace.h"
+
+constexpr int LAYOUT_INDEX_VERSION = 1;
+
+constexpr int FINGERPRINT_GRID = 3;
+constexpr size_t MIN_TOKEN_LENGTH = 3;
+
+// share of the weight of the anchors of a layout a PDF must have to be a candidate
+constexpr double MIN_MATCH_SCORE = 0.75;
+
+// how far ahead of the second candidate the first must be to be picked without the control script
+constexpr double MIN_MATCH_MARGIN = 0.1;
+
+// the anchors of a layout seen in a single PDF are every word of that PDF, too many to be trusted
+constexpr int MIN_IDENTIFY_SAMPLES = 2;
+
+static void add_tokens(std::set<std::string> &tokens, int cell, std::string_view text) {
+    auto add_word = [&](std::string_view word) {
+        if (word.size() < MIN_TOKEN_LENGTH) return;
+        if (std::ranges::any_of(word, [](unsigned char c) { return c >= '0' && c <= '9'; })) return;
+
+        std::string token = std::to_string(cell) + ':';
+        for (unsigned char c : word) {
+            token += char(c < 0x80 ? std::tolower(c) : c);
+        }
+        tokens.insert(std::move(token));
+    };
+
+    // bytes of multibyte utf8 characters are part of words
+    auto is_word_char = [](unsigned char c) {
+        return c >= 0x80 || std::isalnum(c);
+    };
+
+    size_t begin = 0;
+    while (begin < text.size()) {
+        while (begin < text.size() && !is_word_char(text[begin])) ++begin;
+        size_t end = begin;
+        while (end < text.size() && is_word_char(text[end])) ++end;
+        if (end > begin) add_word(text.substr(begin, end - begin));
+        begin = end;
+    }
+}
+
+pdf_fingerprint pdf_fingerprint::extract(const pdf_document &doc) {
+    TRACE_SCOPE("pdf_fingerprint::extract");
+
+    pdf_fingerprint ret;
+    ret.num_pages = doc.num_pages();
+    if (ret.num_pages <= 0) return ret;
+
+    for (int row = 0; row < FINGERPRINT_GRID; ++row) {
+        for (int col = 0; col < FINGERPRINT_GRID; ++col) {
+            pdf_rect rect;
+            rect.x = float(col) / FINGERPRINT_GRID;
+            rect.y = float(row) / FINGERPRINT_GRID;
+            rect.w = 1.f / FINGERPRINT_GRID;
+            rect.h = 1.f / FINGERPRINT_GRID;
+            rect.page = 1;
+            add_tokens(ret.tokens, row * FINGERPRINT_GRID + col, doc.get_text(rect));
+        }
+    }
+    return ret;
+}
+
+layout_index &layout_index::get() {
+    static layout_index index;
+    return index;
+}
+
+void layout_index::setFilename(const std::filesystem::path &filename) {
+    m_filename = filename;
+    m_entries.clear();
+
+    std::ifstream stream(filename);
+    if (stream) {
+        std::ostringstream ss;
+        ss << stream.rdbuf();
+        try {
+            json_value obj = json_value::parse(ss.str());
+            if (obj["version"].as_number() != LAYOUT_INDEX_VERSION) {
+                throw std::out_of_range("Invalid data");
+            }
+            for (const json_value &value : obj["layouts"].as_array()) {
+                entry &e = m_entries.emplace_back();
+                e.layout = value["layout"].as_string();
+                e.samples = int(value["samples"].as_number());
+                e.num_pages = int(value["pages"].as_number());
+                for (const json_value &anchor : value["anchors"].as_array()) {
+                    e.anchors.insert(anchor.as_string());
+                }
+            }
+        } catch (const std::exception &) {
+            // the index is learned again from the next identifications
+            m_entries.clear();
+        }
+    }
+    rebuild();
+}
+
+void layout_index::rebuild() {
+    m_postings.clear();
+    m_weights.clear();
+    for (size_t i = 0; i < m_entries.size(); ++i) {
+        for (const std::string &anchor : m_entries[i].anchors) {
+            m_postings[anchor].push_back(i);
+        }
+    }
+
+    // anchors shared by many layouts tell them apart less
+    for (const auto &[anchor, entries] : m_postings) {
+        m_weights.emplace(anchor, std::log(1.0 + double(m_entries.size()) / entries.size()));
+    }
+    for (entry &e : m_entries) {
+        e.total_weight = 0.0;
+        for (const std::string &anchor : e.anchors) {
+            e.total_weight += m_weights[anchor];
+        }
+    }
+}
+
+bool layout_index::learn(const std::string &layout, const pdf_fingerprint &fingerprint) {
+    if (m_filename.empty() || layout.empty()) return false;
+
+    auto it = std::ranges::find(m_entries, layout, &entry::layout);
+    if (it == m_entries.end()) {
+        entry &e = m_entries.emplace_back();
+        e.layout = layout;
+        e.samples = 1;
+        e.num_pages = fingerprint.num_pages;
+        e.anchors = fingerprint.tokens;
+        rebuild();
+    } else {
+        ++it->samples;
+        if (it->num_pages != fingerprint.num_pages) {
+            it->num_pages = 0;
+        }
+        // the postings only depend on the anchors, which a new sample mostly leaves as they were
+        if (std::erase_if(it->anchors, [&](const std::string &anchor) {
+            return !fingerprint.tokens.contains(anchor);
+        })) {
+            rebuild();
+        }
+    }
+    return true;
+}
+
+std::vector<layout_match> layout_index::find(const pdf_fingerprint &fingerprint) const {
+    TRACE_SCOPE("layout_index::find");
+
+    std::vector<double> scores(m_entries.size(), 0.0);
+    for (const std::string &token : fingerprint.tokens) {
+        auto it = m_postings.find(token);
+        if (it == m_postings.end()) continue;
+        double weight = m_weights.find(token)->second;
+        for (size_t i : it->second) {
+            scores[i] += weight;
+        }
+    }
+
+    std::vector<layout_match> ret;
+    for (size_t i = 0; i < m_entries.size(); ++i) {
+        const entry &e = m_entries[i];
+        if (e.total_weight <= 0.0) continue;
+        if (e.num_pages != 0 && e.num_pages != fingerprint.num_pages) continue;
+        double score = scores[i] / e.total_weight;
+        if (score >= MIN_MATCH_SCORE) {
+            ret.push_back({e.layout, score, e.samples});
+        }
+    }
+    std::ranges::sort(ret, std::ranges::greater{}, &layout_match::score);
+    return ret;
+}
+
+std::optional<std::string> layout_index::identify(const pdf_fingerprint &fingerprint) const {
+    auto matches = find(fingerprint);
+    if (matches.empty()) return std::nullopt;
+    if (matches.size() > 1 && matches[0].score - matches[1].score < MIN_MATCH_MARGIN) return std::nullopt;
+    if (matches[0].samples < MIN_IDENTIFY_SAMPLES) return std::nullopt;
+    return matches[0].layout;
+}
+
+void layout_index::save() {
+    if (m_filename.empty()) return;
+
+    std::string out = "{\"version\":" + std::to_string(LAYOUT_INDEX_VERSION) + ",\"layouts\":[";
+    for (size_t i = 0; i < m_entries.size(); ++i) {
+        const entry &e = m_entries[i];
+        if (i != 0) out += ',';
+        out += "\n{\"layout\":";
+        append_json_string(out, e.layout);
+        out += ",\"samples\":" + std::to_string(e.samples) + ",\"pages\":" + std::to_string(e.num_pages) + ",\"anchors\":[";
+        bool first = true;
+        for (const std::string &anchor : e.anchors) {
+            if (!first) out += ',';
+            first = false;
+            append_json_string(out, anchor);
+        }
+        out += "]}";
+    }
+    out += "]}\n";
+
+    std::error_code ec;
+    std::filesystem::create_directories(m_filename.parent_path(), ec);
+    atomic_write_file(m_filename, out);
+}
\ No newline at end of file
@@ -0,0 +1,82 @@
+#ifndef __LAYOUT_INDEX_H__
+#define __LAYOUT_INDEX_H__
+
+#include <filesystem>
+#include <map>
+#include <optional>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "pdf_document.h"
+
+using namespace bls;
+
+// Cheap features of a PDF: its page count and the words of the first page,
+// each tagged with the cell of a 3x3 grid it was found in, so that the same word
+// in the header and in the body of a bill are different anchors.
+// Words with digits are left out, they are mostly amounts, dates and numbers that change from bill to bill.
+struct pdf_fingerprint {
+    int num_pages = 0;
+    std::set<std::string> tokens;
+
+    static pdf_fingerprint extract(const pdf_document &doc);
+};
+
+struct layout_match {
+    std::string layout;
+    double score;
+    int samples;
+};
+
+// Index from fingerprints to the layouts that were found for them.
+// Every identification made by the control script teaches the index the anchors of the layout,
+// which are the tokens common to all the PDFs identified with it. A PDF is then matched against
+// the anchors through an inverted index, each anchor weighted by how few layouts share it.
+class layout_index {
+public:
+    static layout_index &get();
+
+    // loads the index from filename, an empty filename disables the index
+    void setFilename(const std::filesystem::path &filename);
+
+    // returns false when the index is left as it was, and there is nothing to save
+    bool learn(const std::string &layout, const pdf_fingerprint &fingerprint);
+
+    // the layouts whose anchors the PDF mostly has, best first
+    std::vector<layout_match> find(const pdf_fingerprint &fingerprint) const;
+
+    // the layout of the PDF if a single candidate stands out and was learned from enough PDFs,
+    // otherwise the control script decides
+    std::optional<std::string> identify(const pdf_fingerprint &fingerprint) const;
+
+    size_t size() const {
+        return m_entries.size();
+    }
+
+    // throws std::runtime_error if the file can't be written
+    void save();
+
+private:
+    layout_index() = default;
+
+    void rebuild();
+
+private:
+    struct entry {
+        std::string layout;
+        int samples = 0;
+        int num_pages = 0;  // 0 if the PDFs of the layout don't all have the same page count
+        std::set<std::string> anchors;
+        double total_weight = 0.0;
+    };
+
+    std::filesystem::path m_filename;
+    std::vector<entry> m_entries;
+
+    // anchor to the entries that have it, and its weight
+    std::map<std::string, std::vector<size_t>, std::less<>> m_postings;
+    std::map<std::string, double, std::less<>> m_weights;
+};
+
+#endif
\ No newline at end of file
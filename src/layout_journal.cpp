@@ -0,0 +1,389 @@
+#include "layout_journal.h"
+
+#include <wx/stdpaths.h>
+
+#include <fstream>
+#include <sstream>
+
+#include "layout_serial.h"
+#include "file_hash.h"
+#include "file_utils.h"
+
+constexpr uint32_t JOURNAL_MAGIC = 0x4a534c42; // "BLSJ"
+constexpr uint32_t SNAPSHOT_MAGIC = 0x53534c42; // "BLSS"
+constexpr uint64_t JOURNAL_VERSION = 1;
+
+constexpr size_t COMPACT_RECORDS = 256;
+constexpr size_t COMPACT_BYTES = 1024 * 1024;
+
+enum : uint64_t {
+    RECORD_SPLICE = 1,
+    RECORD_OPTIONS = 2,
+};
+
+// the journal only applies on top of the exact file it was started from
+struct journal_base {
+    int64_t mtime = 0;
+    uint64_t size = 0;
+
+    bool operator == (const journal_base &other) const = default;
+};
+
+static journal_base get_base(const std::filesystem::path &filename) {
+    journal_base base;
+    std::error_code ec;
+    if (!filename.empty()) {
+        base.mtime = std::filesystem::last_write_time(filename, ec).time_since_epoch().count();
+        base.size = std::filesystem::file_size(filename, ec);
+    }
+    return base;
+}
+
+static std::filesystem::path get_journal_filename(const std::filesystem::path &layout_filename) {
+    std::filesystem::path directory(wxStandardPaths::Get().GetUserLocalDataDir().ToStdString());
+    std::error_code ec;
+    std::string name = layout_filename.empty() ? "untitled"
+        : hash_to_hex(hash_string(std::filesystem::absolute(layout_filename, ec).string()));
+    return directory / "autosave" / (name + ".journal");
+}
+
+static std::filesystem::path get_snapshot_filename(std::filesystem::path journal_filename) {
+    return journal_filename.replace_extension(".snapshot");
+}
+
+static std::string make_header(uint32_t magic, const journal_base &base, uint64_t seq) {
+    binary_writer writer;
+    writer.write_bytes(&magic, sizeof(magic));
+    writer.write_varint(JOURNAL_VERSION);
+    writer.write_signed(base.mtime);
+    writer.write_varint(base.size);
+    writer.write_varint(seq);
+    return writer.release();
+}
+
+static uint64_t read_header(binary_reader &reader, uint32_t magic, journal_base &base) {
+    uint32_t file_magic;
+    reader.read_bytes(&file_magic, sizeof(file_magic));
+    if (file_magic != magic || reader.read_varint() != JOURNAL_VERSION) {
+        throw std::out_of_range("Invalid data");
+    }
+    base.mtime = reader.read_signed();
+    base.size = reader.read_varint();
+    return reader.read_varint();
+}
+
+// records are framed by their length and a checksum, so that a torn write at the end is ignored
+static void append_record(binary_writer &out, const binary_writer &record) {
+    out.write_varint(record.data().size());
+    out.write_bytes(record.data().data(), record.data().size());
+    uint32_t checksum = uint32_t(hash_string(record.data()));
+    out.write_bytes(&checksum, sizeof(checksum));
+}
+
+static std::string read_file(const std::filesystem::path &filename) {
+    std::ifstream ifs(filename, std::ios::binary);
+    if (!ifs) return {};
+    std::stringstream ss;
+    ss << ifs.rdbuf();
+    return ss.str();
+}
+
+// applies the journal of filename on top of layout, only validating it if apply is false
+static bool replay_journal(const std::filesystem::path &filename, layout_box_list &layout, bool apply) {
+    auto journal_filename = get_journal_filename(filename);
+    journal_base current = get_base(filename);
+    bool changed = false;
+    uint64_t seq = 0;
+
+    std::string snapshot_data = read_file(get_snapshot_filename(journal_filename));
+    if (!snapshot_data.empty()) {
+        try {
+            binary_reader reader(snapshot_data);
+            journal_base base;
+            uint64_t snapshot_seq = read_header(reader, SNAPSHOT_MAGIC, base);
+            if (base == current) {
+                layout_box_list snapshot;
+                reader.read_options(snapshot);
+                uint64_t count = reader.read_varint();
+                for (uint64_t i = 0; i < count; ++i) {
+                    snapshot.push_back(reader.read_box());
+                }
+                if (apply) {
+                    snapshot.filename = layout.filename;
+                    layout = std::move(snapshot);
+                }
+                seq = snapshot_seq;
+                changed = true;
+            }
+        } catch (const std::out_of_range &) {
+            // an incomplete snapshot is never renamed in place, this is a foreign file
+        }
+    }
+
+    std::string journal_data = read_file(journal_filename);
+    if (journal_data.empty()) return changed;
+
+    try {
+        binary_reader reader(journal_data);
+        journal_base base;
+        uint64_t record_seq = read_header(reader, JOURNAL_MAGIC, base);
+        if (base != current || record_seq > seq) return changed;
+
+        while (!reader.at_end()) {
+            std::string record = reader.read_string();
+            uint32_t checksum;
+            reader.read_bytes(&checksum, sizeof(checksum));
+            if (checksum != uint32_t(hash_string(record))) break;
+
+            // records already folded into the snapshot are skipped
+            if (record_seq++ < seq) continue;
+
+            binary_reader record_reader(record);
+            switch (record_reader.read_varint()) {
+            case RECORD_SPLICE: {
+                uint64_t begin = record_reader.read_varint();
+                uint64_t erase_count = record_reader.read_varint();
+                uint64_t insert_count = record_reader.read_varint();
+                if (apply) {
+                    if (begin + erase_count > layout.size()) throw std::out_of_range("Invalid data");
+                    auto it = layout.erase(std::next(layout.begin(), begin), std::next(layout.begin(), begin + erase_count));
+                    for (uint64_t i = 0; i < insert_count; ++i) {
+                        layout.insert(it, record_reader.read_box());
+                    }
+                }
+                break;
+            }
+            case RECORD_OPTIONS:
+                if (apply) {
+                    record_reader.read_options(layout);
+                }
+                break;
+            default:
+                throw std::out_of_range("Invalid data");
+            }
+            changed = true;
+        }
+    } catch (const std::out_of_range &) {
+        // torn tail, everything before it was applied
+    }
+    return changed;
+}
+
+bool layout_journal::hasRecovery(const std::filesystem::path &filename) {
+    layout_box_list dummy;
+    return replay_journal(filename, dummy, false);
+}
+
+bool layout_journal::recover(layout_box_list &layout) {
+    return replay_journal(layout.filename, layout, true);
+}
+
+layout_journal::~layout_journal() {
+    {
+        std::scoped_lock lock(m_mutex);
+        m_stopped = true;
+    }
+    m_cond.notify_all();
+    if (m_writer.joinable()) {
+        m_writer.join();
+    }
+    if (m_file) {
+        fclose(m_file);
+    }
+}
+
+void layout_journal::reset(const layout_box_list &layout, bool recovered) {
+    auto filename = get_journal_filename(layout.filename);
+    if (!m_filename.empty() && m_filename != filename) {
+        discard();
+    }
+
+    m_last = layout;
+    m_filename = filename;
+    journal_base base = get_base(layout.filename);
+    m_base_mtime = base.mtime;
+    m_base_size = base.size;
+    m_seq = 0;
+
+    if (recovered) {
+        compact();
+    } else {
+        m_records = m_bytes = 0;
+        push({task::RESET, m_filename, make_header(JOURNAL_MAGIC, base, 0)});
+    }
+}
+
+void layout_journal::record(const layout_box_list &layout) {
+    if (m_filename.empty()) return;
+
+    binary_writer out;
+    size_t num_records = 0;
+
+    // the edit is the range between the common prefix and the common suffix of the two lists
+    size_t prefix = 0;
+    auto last_it = m_last.begin();
+    auto it = layout.begin();
+    while (last_it != m_last.end() && it != layout.end() && boxes_equal(*last_it, *it)) {
+        ++last_it;
+        ++it;
+        ++prefix;
+    }
+    size_t suffix = 0;
+    size_t max_suffix = std::min(m_last.size(), layout.size()) - prefix;
+    auto last_rit = m_last.rbegin();
+    auto rit = layout.rbegin();
+    while (suffix < max_suffix && boxes_equal(*last_rit, *rit)) {
+        ++last_rit;
+        ++rit;
+        ++suffix;
+    }
+
+    size_t erase_count = m_last.size() - prefix - suffix;
+    size_t insert_count = layout.size() - prefix - suffix;
+    if (erase_count != 0 || insert_count != 0) {
+        binary_writer record;
+        record.write_varint(RECORD_SPLICE);
+        record.write_varint(prefix);
+        record.write_varint(erase_count);
+        record.write_varint(insert_count);
+
+        auto erase_begin = std::next(m_last.begin(), prefix);
+        auto insert_pos = m_last.erase(erase_begin, std::next(erase_begin, erase_count));
+        for (auto src = it; insert_count-- > 0; ++src) {
+            record.write_box(*src);
+            m_last.insert(insert_pos, *src);
+        }
+        append_record(out, record);
+        ++num_records;
+    }
+
+    if (m_last.find_layout_flag != layout.find_layout_flag || m_last.language != layout.language) {
+        binary_writer record;
+        record.write_varint(RECORD_OPTIONS);
+        record.write_options(layout);
+        m_last.find_layout_flag = layout.find_layout_flag;
+        m_last.language = layout.language;
+        append_record(out, record);
+        ++num_records;
+    }
+
+    if (num_records != 0) {
+        m_seq += num_records;
+        m_records += num_records;
+        m_bytes += out.data().size();
+        push({task::APPEND, m_filename, out.release()});
+
+        if (m_records >= COMPACT_RECORDS || m_bytes >= COMPACT_BYTES) {
+            compact();
+        }
+    }
+}
+
+void layout_journal::compact() {
+    if (m_filename.empty()) return;
+
+    m_records = m_bytes = 0;
+    push({task::COMPACT, m_filename, make_header(JOURNAL_MAGIC, {m_base_mtime, m_base_size}, m_seq),
+        std::make_shared<const layout_box_list>(m_last), m_seq});
+}
+
+void layout_journal::discard() {
+    if (m_filename.empty()) return;
+
+    push({task::DISCARD, m_filename});
+    m_filename.clear();
+    m_last.clear();
+}
+
+void layout_journal::push(task &&t) {
+    {
+        std::scoped_lock lock(m_mutex);
+        if (!m_writer.joinable()) {
+            m_writer = std::thread(&layout_journal::writerLoop, this);
+        }
+        m_tasks.push_back(std::move(t));
+    }
+    m_cond.notify_one();
+}
+
+void layout_journal::writerLoop() {
+    while (true) {
+        task t;
+        bool last;
+        {
+            std::unique_lock lock(m_mutex);
+            m_cond.wait(lock, [&]{ return m_stopped || !m_tasks.empty(); });
+            if (m_tasks.empty()) break;
+            t = std::move(m_tasks.front());
+            m_tasks.pop_front();
+            last = m_tasks.empty();
+        }
+        try {
+            process(t);
+            // appends are batched, the file is committed once the queue runs dry
+            if (last && m_file) {
+                sync_file(m_file);
+            }
+        } catch (const std::exception &) {
+            // autosave failures must never interrupt editing
+        }
+    }
+}
+
+void layout_journal::process(task &t) {
+    std::error_code ec;
+    std::filesystem::create_directories(t.filename.parent_path(), ec);
+
+    auto close_file = [&]{
+        if (m_file) {
+            fclose(m_file);
+            m_file = nullptr;
+        }
+    };
+
+    switch (t.type) {
+    case task::APPEND:
+        if (!m_file || m_open_filename != t.filename) {
+            close_file();
+#ifdef _WIN32
+            m_file = _wfopen(t.filename.c_str(), L"ab");
+#else
+            m_file = fopen(t.filename.c_str(), "ab");
+#endif
+            m_open_filename = t.filename;
+        }
+        if (m_file) {
+            fwrite(t.data.data(), 1, t.data.size(), m_file);
+        }
+        break;
+    case task::RESET:
+        close_file();
+        atomic_write_file(t.filename, t.data);
+        std::filesystem::remove(get_snapshot_filename(t.filename), ec);
+        break;
+    case task::COMPACT: {
+        // the snapshot shares the base of the journal header it is written with
+        binary_reader header_reader(t.data);
+        journal_base base;
+        read_header(header_reader, JOURNAL_MAGIC, base);
+
+        binary_writer snapshot;
+        std::string header = make_header(SNAPSHOT_MAGIC, base, t.seq);
+        snapshot.write_bytes(header.data(), header.size());
+        snapshot.write_options(*t.snapshot);
+        snapshot.write_varint(t.snapshot->size());
+        for (const layout_box &box : *t.snapshot) {
+            snapshot.write_box(box);
+        }
+        close_file();
+        atomic_write_file(get_snapshot_filename(t.filename), snapshot.data());
+        atomic_write_file(t.filename, t.data);
+        break;
+    }
+    case task::DISCARD:
+        close_file();
+        std::filesystem::remove(t.filename, ec);
+        std::filesystem::remove(get_snapshot_filename(t.filename), ec);
+        break;
+    }
+}
\ No newline at end of file
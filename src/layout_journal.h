@@ -0,0 +1,78 @@
+#ifndef __LAYOUT_JOURNAL_H__
+#define __LAYOUT_JOURNAL_H__
+
+#include <filesystem>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <string>
+#include <cstdio>
+
+#include "layout.h"
+
+using namespace bls;
+
+// Append-only journal of the edits made to a layout since it was last saved.
+// Records are the spliced range between two states of the box list, encoded
+// on the GUI thread and written by a background thread. Every so often the
+// journal is folded into an atomically written snapshot, so that the cost of
+// autosaving does not depend on the size of the layout.
+class layout_journal {
+public:
+    layout_journal() = default;
+    ~layout_journal();
+
+    // starts a new journal on top of the layout as it is saved on disk,
+    // a recovered layout is snapshotted right away instead
+    void reset(const layout_box_list &layout, bool recovered = false);
+
+    // appends the difference between the last recorded state and layout
+    void record(const layout_box_list &layout);
+
+    // writes the recorded state as a snapshot and empties the journal
+    void compact();
+
+    // removes the journal, once its changes are saved or discarded
+    void discard();
+
+    // true if unsaved changes were journaled for the layout file
+    static bool hasRecovery(const std::filesystem::path &filename);
+
+    // replays the journal on top of layout, which must have just been loaded from its file
+    static bool recover(layout_box_list &layout);
+
+private:
+    struct task {
+        enum { APPEND, RESET, COMPACT, DISCARD } type;
+        std::filesystem::path filename;
+        std::string data;
+        std::shared_ptr<const layout_box_list> snapshot;
+        uint64_t seq = 0;
+    };
+
+    void push(task &&t);
+    void writerLoop();
+    void process(task &t);
+
+private:
+    layout_box_list m_last;
+    std::filesystem::path m_filename;
+    int64_t m_base_mtime = 0;
+    uint64_t m_base_size = 0;
+    uint64_t m_seq = 0;
+    size_t m_records = 0;
+    size_t m_bytes = 0;
+
+    std::thread m_writer;
+    std::mutex m_mutex;
+    std::condition_variable m_cond;
+    std::deque<task> m_tasks;
+    bool m_stopped = false;
+
+    FILE *m_file = nullptr;
+    std::filesystem::path m_open_filename;
+};
+
+#endif
\ No newline at end of file
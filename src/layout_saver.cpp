@@ -0,0 +1,128 @@
+#include "layout_saver.h"
+
+#include <format>
+
+#include "file_utils.h"
+#include "layout_cache.h"
+
+wxDEFINE_EVENT(wxEVT_COMMAND_LAYOUT_SAVED, wxThreadEvent);
+
+layout_save_thread::layout_save_thread(wxEvtHandler *parent, std::shared_ptr<layout_save_request> request)
+    : wxThread(wxTHREAD_JOINABLE), parent(parent), m_request(std::move(request)) {}
+
+static void save_layout(layout_box_list &layout) {
+    auto filename = layout.filename;
+    auto tmp_filename = temp_filename_for(filename);
+
+    layout.filename = tmp_filename;
+    try {
+        layout.save_file();
+    } catch (...) {
+        layout.filename = filename;
+        std::error_code ec;
+        std::filesystem::remove(tmp_filename, ec);
+        throw;
+    }
+    layout.filename = filename;
+
+    if (!sync_file(tmp_filename)) {
+        std::error_code ec;
+        std::filesystem::remove(tmp_filename, ec);
+        throw std::runtime_error(std::format("Can't write {}", filename.string()));
+    }
+    atomic_replace_file(tmp_filename, filename);
+
+    layout_cache::get().store(layout);
+}
+
+wxThread::ExitCode layout_save_thread::Entry() {
+    while (true) {
+        std::unique_ptr<layout_box_list> layout;
+        int generation;
+        {
+            std::unique_lock lock(m_request->mutex);
+            m_request->cond.wait(lock, [&]{ return m_request->stopped || m_request->pending; });
+            if (!m_request->pending) break;
+            m_request->pending = false;
+            m_request->busy = true;
+            layout = std::move(m_request->layout);
+            generation = m_request->generation;
+        }
+
+        std::string error;
+        try {
+            save_layout(*layout);
+        } catch (const std::exception &e) {
+            error = e.what();
+        }
+
+        {
+            std::scoped_lock lock(m_request->mutex);
+            m_request->busy = false;
+            m_request->last_error = error;
+        }
+        m_request->cond.notify_all();
+
+        auto *evt = new wxThreadEvent(wxEVT_COMMAND_LAYOUT_SAVED);
+        evt->SetPayload(layout_save_result{generation, std::move(layout), std::move(error)});
+        wxQueueEvent(parent, evt);
+    }
+    return (wxThread::ExitCode) 0;
+}
+
+layout_saver::~layout_saver() {
+    if (m_request) {
+        {
+            std::scoped_lock lock(m_request->mutex);
+            m_request->stopped = true;
+        }
+        m_request->cond.notify_all();
+    }
+    // a pending save is still completed before the thread exits
+    if (m_thread) {
+        m_thread->Wait();
+        delete m_thread;
+    }
+}
+
+void layout_saver::save(const layout_box_list &layout, int generation) {
+    if (!m_request) {
+        m_request = std::make_shared<layout_save_request>();
+        m_thread = new layout_save_thread(parent, m_request);
+        if (m_thread->Run() != wxTHREAD_NO_ERROR) {
+            delete m_thread;
+            m_thread = nullptr;
+        }
+    }
+    if (!m_thread) {
+        // falls back to saving on the calling thread
+        auto copy = std::make_shared<layout_box_list>(layout);
+        std::string error;
+        try {
+            save_layout(*copy);
+        } catch (const std::exception &e) {
+            error = e.what();
+        }
+        m_request->last_error = error;
+        auto *evt = new wxThreadEvent(wxEVT_COMMAND_LAYOUT_SAVED);
+        evt->SetPayload(layout_save_result{generation, std::move(copy), std::move(error)});
+        wxQueueEvent(parent, evt);
+        return;
+    }
+    {
+        std::scoped_lock lock(m_request->mutex);
+        m_request->layout = std::make_unique<layout_box_list>(layout);
+        m_request->generation = generation;
+        m_request->pending = true;
+    }
+    m_request->cond.notify_all();
+}
+
+bool layout_saver::flush(std::string &error) {
+    if (!m_request) return true;
+
+    std::unique_lock lock(m_request->mutex);
+    m_request->cond.wait(lock, [&]{ return !m_request->pending && !m_request->busy; });
+    error = m_request->last_error;
+    return error.empty();
+}
\ No newline at end of file
@@ -0,0 +1,70 @@
+#ifndef __LAYOUT_SAVER_H__
+#define __LAYOUT_SAVER_H__
+
+#include <wx/thread.h>
+#include <wx/event.h>
+
+#include <mutex>
+#include <condition_variable>
+#include <memory>
+#include <string>
+
+#include "layout.h"
+
+using namespace bls;
+
+wxDECLARE_EVENT(wxEVT_COMMAND_LAYOUT_SAVED, wxThreadEvent);
+
+struct layout_save_result {
+    int generation;
+    std::shared_ptr<const layout_box_list> layout;
+    std::string error;
+};
+
+// Single slot mailbox between the editor and the save thread.
+// A save requested while another one is still pending replaces it.
+struct layout_save_request {
+    std::mutex mutex;
+    std::condition_variable cond;
+    bool pending = false;
+    bool busy = false;
+    bool stopped = false;
+
+    std::unique_ptr<layout_box_list> layout;
+    int generation = 0;
+    std::string last_error;
+};
+
+class layout_save_thread : public wxThread {
+public:
+    layout_save_thread(wxEvtHandler *parent, std::shared_ptr<layout_save_request> request);
+
+protected:
+    virtual ExitCode Entry() override;
+
+private:
+    wxEvtHandler *parent;
+    std::shared_ptr<layout_save_request> m_request;
+};
+
+// Writes layouts on a background thread: the file is written to a temporary path,
+// committed to disk and renamed over the original, so it is never left half written.
+class layout_saver {
+public:
+    layout_saver(wxEvtHandler *parent) : parent(parent) {}
+    ~layout_saver();
+
+    // generation is handed back with the result, to tell if the layout was edited in the meantime
+    void save(const layout_box_list &layout, int generation);
+
+    // waits for the pending save, returns false and the error if it failed
+    bool flush(std::string &error);
+
+private:
+    wxEvtHandler *parent;
+
+    std::shared_ptr<layout_save_request> m_request;
+    layout_save_thread *m_thread = nullptr;
+};
+
+#endif
\ No newline at end of file
@@ -0,0 +1,176 @@
+#include "layout_serial.h"
+
+#include <cstring>
+#include <stdexcept>
+
+void binary_writer::write_varint(uint64_t value) {
+    while (value >= 0x80) {
+        m_buffer.push_back(char(value | 0x80));
+        value >>= 7;
+    }
+    m_buffer.push_back(char(value));
+}
+
+void binary_writer::write_signed(int64_t value) {
+    write_varint((uint64_t(value) << 1) ^ uint64_t(value >> 63));
+}
+
+void binary_writer::write_float(float value) {
+    uint32_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    for (int i = 0; i < 4; ++i) {
+        m_buffer.push_back(char(bits >> (i * 8)));
+    }
+}
+
+void binary_writer::write_string(std::string_view str) {
+    write_varint(str.size());
+    m_buffer.append(str);
+}
+
+void binary_writer::write_bytes(const void *data, size_t size) {
+    m_buffer.append(static_cast<const char *>(data), size);
+}
+
+// flags are stored as a bitmask indexed by their position in the enum declaration
+template<typename E>
+static uint64_t flags_to_mask(const enums::bitset<E> &flags) {
+    uint64_t mask = 0;
+    [&]<E ... Es>(enums::enum_sequence<Es...>) {
+        size_t i = 0;
+        auto add_flag = [&](E flag) {
+            if (flags.check(flag)) mask |= uint64_t(1) << i;
+            ++i;
+        };
+        (add_flag(Es), ...);
+    }(enums::make_enum_sequence<E>());
+    return mask;
+}
+
+template<typename E>
+static void mask_to_flags(uint64_t mask, enums::bitset<E> &flags) {
+    constexpr size_t num_flags = []<E ... Es>(enums::enum_sequence<Es...>) {
+        return sizeof...(Es);
+    }(enums::make_enum_sequence<E>());
+    if constexpr (num_flags < 64) {
+        if (mask >> num_flags) throw std::out_of_range("Invalid data");
+    }
+    [&]<E ... Es>(enums::enum_sequence<Es...>) {
+        size_t i = 0;
+        auto set_flag = [&](E flag) {
+            flags.unset(flag);
+            if (mask & (uint64_t(1) << i)) flags.set(flag);
+            ++i;
+        };
+        (set_flag(Es), ...);
+    }(enums::make_enum_sequence<E>());
+}
+
+void binary_writer::write_box(const layout_box &box) {
+    write_float(box.x);
+    write_float(box.y);
+    write_float(box.w);
+    write_float(box.h);
+    write_signed(box.page);
+    write_varint(static_cast<uint64_t>(box.mode));
+    write_varint(get_flags_mask(box));
+    write_string(box.name);
+    write_string(box.script);
+    write_string(box.spacers);
+    write_string(box.goto_label);
+}
+
+void binary_writer::write_options(const layout_box_list &layout) {
+    write_varint(layout.find_layout_flag ? 1 : 0);
+    write_string(layout.language);
+}
+
+uint64_t binary_reader::read_varint() {
+    uint64_t value = 0;
+    for (int shift = 0; shift < 64; shift += 7) {
+        if (m_offset >= m_data.size()) throw std::out_of_range("Invalid data");
+        uint8_t byte = m_data[m_offset++];
+        value |= uint64_t(byte & 0x7f) << shift;
+        if (!(byte & 0x80)) return value;
+    }
+    throw std::out_of_range("Invalid data");
+}
+
+int64_t binary_reader::read_signed() {
+    uint64_t value = read_varint();
+    return int64_t(value >> 1) ^ -int64_t(value & 1);
+}
+
+float binary_reader::read_float() {
+    if (m_offset + 4 > m_data.size()) throw std::out_of_range("Invalid data");
+    uint32_t bits = 0;
+    for (int i = 0; i < 4; ++i) {
+        bits |= uint32_t(uint8_t(m_data[m_offset++])) << (i * 8);
+    }
+    float value;
+    memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+std::string binary_reader::read_string() {
+    uint64_t len = read_varint();
+    if (len > m_data.size() - m_offset) throw std::out_of_range("Invalid data");
+    std::string ret(m_data.substr(m_offset, len));
+    m_offset += len;
+    return ret;
+}
+
+void binary_reader::read_bytes(void *data, size_t size) {
+    if (size > m_data.size() - m_offset) throw std::out_of_range("Invalid data");
+    memcpy(data, m_data.data() + m_offset, size);
+    m_offset += size;
+}
+
+layout_box binary_reader::read_box() {
+    layout_box box;
+    box.x = read_float();
+    box.y = read_float();
+    box.w = read_float();
+    box.h = read_float();
+    box.page = read_signed();
+    set_read_mode(box, read_varint());
+    set_flags_mask(box, read_varint());
+    box.name = read_string();
+    box.script = read_string();
+    box.spacers = read_string();
+    box.goto_label = read_string();
+    return box;
+}
+
+void binary_reader::read_options(layout_box_list &layout) {
+    layout.find_layout_flag = read_varint() != 0;
+    layout.language = read_string();
+}
+
+bool boxes_equal(const layout_box &a, const layout_box &b) {
+    return a.x == b.x && a.y == b.y && a.w == b.w && a.h == b.h
+        && a.page == b.page
+        && a.mode == b.mode
+        && get_flags_mask(a) == get_flags_mask(b)
+        && a.name == b.name
+        && a.script == b.script
+        && a.spacers == b.spacers
+        && a.goto_label == b.goto_label;
+}
+
+uint64_t get_flags_mask(const layout_box &box) {
+    return flags_to_mask(box.flags);
+}
+
+void set_flags_mask(layout_box &box, uint64_t mask) {
+    mask_to_flags(mask, box.flags);
+}
+
+void set_read_mode(layout_box &box, uint64_t value) {
+    using mode_type = decltype(box.mode);
+    bool valid = [&]<mode_type ... Es>(enums::enum_sequence<Es...>) {
+        return ((value == uint64_t(Es)) || ...);
+    }(enums::make_enum_sequence<mode_type>());
+    if (!valid) throw std::out_of_range("Invalid data");
+    box.mode = static_cast<mode_type>(value);
+}
\ No newline at end of file
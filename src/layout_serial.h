@@ -0,0 +1,78 @@
+#ifndef __LAYOUT_SERIAL_H__
+#define __LAYOUT_SERIAL_H__
+
+#include <string>
+#include <string_view>
+#include <cstdint>
+
+#include "layout.h"
+
+using namespace bls;
+
+// Compact binary encoding of layout boxes: varint integers and lengths, raw little endian floats.
+// Shared by the edit journal, the layout sidecar cache and the clipboard.
+class binary_writer {
+public:
+    void write_varint(uint64_t value);
+    void write_signed(int64_t value);
+    void write_float(float value);
+    void write_string(std::string_view str);
+    void write_bytes(const void *data, size_t size);
+
+    void write_box(const layout_box &box);
+    void write_options(const layout_box_list &layout);
+
+    const std::string &data() const {
+        return m_buffer;
+    }
+
+    std::string release() {
+        return std::move(m_buffer);
+    }
+
+    void clear() {
+        m_buffer.clear();
+    }
+
+private:
+    std::string m_buffer;
+};
+
+// Reads what binary_writer wrote, throws std::out_of_range on truncated or malformed data
+class binary_reader {
+public:
+    binary_reader(std::string_view data) : m_data(data) {}
+
+    uint64_t read_varint();
+    int64_t read_signed();
+    float read_float();
+    std::string read_string();
+    void read_bytes(void *data, size_t size);
+
+    layout_box read_box();
+    void read_options(layout_box_list &layout);
+
+    bool at_end() const {
+        return m_offset >= m_data.size();
+    }
+
+    size_t offset() const {
+        return m_offset;
+    }
+
+private:
+    std::string_view m_data;
+    size_t m_offset = 0;
+};
+
+bool boxes_equal(const layout_box &a, const layout_box &b);
+
+// box flags as a bitmask indexed by their position in the enum declaration,
+// set_flags_mask throws std::out_of_range on bits that are not a known flag
+uint64_t get_flags_mask(const layout_box &box);
+void set_flags_mask(layout_box &box, uint64_t mask);
+
+// throws std::out_of_range if the value is not one of the read modes
+void set_read_mode(layout_box &box, uint64_t value);
+
+#endif
\ No newline at end of file
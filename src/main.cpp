@@ -3,9 +3,14 @@
 #include <wx/cmdline.h>
 #include <wx/config.h>
 
+#include "input_session.h"
+#include "trace.h"
+#include "render_cache.h"
+
 class MainApp : public wxApp {
 public:
     virtual bool OnInit() override;
+    virtual int OnExit() override;
     virtual void OnInitCmdLine(wxCmdLineParser &parser) override;
     virtual bool OnCmdLineParsed(wxCmdLineParser &parser) override;
 
@@ -14,6 +19,11 @@ private:
 
     wxString bls_filename;
     wxString pdf_filename;
+
+    wxString record_filename;
+    wxString replay_filename;
+    wxString replay_report_filename;
+    wxString trace_filename;
 };
 wxIMPLEMENT_APP(MainApp);
 
@@ -22,12 +32,27 @@ bool MainApp::OnInit() {
         return false;
     }
 
+    tracer::get().setThreadName("main");
+
     wxConfig::Set(new wxConfig("BillLayoutScript"));
     
     wxImage::AddHandler(new wxPNGHandler);
 
     editor = new frame_editor();
 
+    // a replay runs against the files it was recorded with, unless others are given
+    input_session session;
+    if (!replay_filename.empty()) {
+        try {
+            session = input_session::load(replay_filename.ToStdString());
+        } catch (const std::exception &) {
+            wxMessageBox(wxintl::translate("CANT_OPEN_FILE", replay_filename.ToStdString()), wxintl::translate("PROGRAM_NAME"), wxOK | wxICON_ERROR);
+            return false;
+        }
+        if (bls_filename.empty()) bls_filename = session.layout_filename.string();
+        if (pdf_filename.empty()) pdf_filename = session.pdf_filename.string();
+    }
+
     if (!bls_filename.empty()) {
         editor->openFile(bls_filename);
     }
@@ -35,13 +60,36 @@ bool MainApp::OnInit() {
         editor->loadPdf(pdf_filename);
     }
 
+    if (!replay_filename.empty()) {
+        editor->startReplay(std::move(session), replay_report_filename);
+    } else if (!record_filename.empty()) {
+        input_recorder::get().start(record_filename.ToStdString(), bls_filename.ToStdString(), pdf_filename.ToStdString());
+    }
+
     SetTopWindow(editor);
     return true;
 }
 
+int MainApp::OnExit() {
+    render_cache::get().shutdown();
+    input_recorder::get().stop();
+    if (!trace_filename.empty()) {
+        try {
+            tracer::get().exportChrome(trace_filename.ToStdString());
+        } catch (const std::exception &error) {
+            wxLogError("%s", error.what());
+        }
+    }
+    return wxApp::OnExit();
+}
+
 void MainApp::OnInitCmdLine(wxCmdLineParser &parser) {
     parser.AddParam("input-bls", wxCMD_LINE_VAL_STRING, wxCMD_LINE_PARAM_OPTIONAL);
     parser.AddOption("p", "input-pdf", wxintl::translate("PDF_INPUT_FILE"));
+    parser.AddLongOption("record", wxintl::translate("RECORD_SESSION_FILE"));
+    parser.AddLongOption("replay", wxintl::translate("REPLAY_SESSION_FILE"));
+    parser.AddLongOption("replay-report", wxintl::translate("REPLAY_REPORT_FILE"));
+    parser.AddLongOption("trace", wxintl::translate("TRACE_OUTPUT_FILE"));
 }
 
 bool MainApp::OnCmdLineParsed(wxCmdLineParser &parser) {
@@ -49,6 +97,18 @@ bool MainApp::OnCmdLineParsed(wxCmdLineParser &parser) {
         bls_filename = parser.GetParam(0);
     }
     parser.Found("p", &pdf_filename);
+    parser.Found("record", &record_filename);
+    parser.Found("replay", &replay_filename);
+    parser.Found("replay-report", &replay_report_filename);
+    parser.Found("trace", &trace_filename);
+
+#ifdef _WIN32
+    // the release build has no console to print the report to
+    if (!replay_filename.empty() && replay_report_filename.empty()) {
+        wxMessageBox(wxintl::translate("REPLAY_REPORT_REQUIRED"), wxintl::translate("PROGRAM_NAME"), wxOK | wxICON_ERROR);
+        return false;
+    }
+#endif
 
     return true;
 }
\ No newline at end of file
@@ -0,0 +1,37 @@
+#include "memory_budget.h"
+
+#include "perf_counters.h"
+#include "buffer_pool.h"
+
+int64_t memory_usage(memory_subsystem subsystem) {
+    const auto &counters = perf_counters::get();
+    switch (subsystem) {
+    case memory_subsystem::page_rasters:    return counters.raster_bytes;
+    case memory_subsystem::buffer_pool:     return int64_t(buffer_pool::get().bytes_pooled());
+    case memory_subsystem::scaled_bitmaps:  return counters.scaled_bitmap_bytes;
+    case memory_subsystem::undo_history:    return counters.history_bytes;
+    case memory_subsystem::output_models:   return counters.output_model_bytes;
+    case memory_subsystem::text_dialogs:    return counters.text_dialog_bytes;
+    }
+    return 0;
+}
+
+int64_t memory_usage_total() {
+    int64_t total = 0;
+    for (int i = 0; i < MEMORY_SUBSYSTEM_COUNT; ++i) {
+        total += memory_usage(static_cast<memory_subsystem>(i));
+    }
+    return total;
+}
+
+const char *memory_subsystem_label(memory_subsystem subsystem) {
+    switch (subsystem) {
+    case memory_subsystem::page_rasters:    return "MEMORY_PAGE_RASTERS";
+    case memory_subsystem::buffer_pool:     return "MEMORY_BUFFER_POOL";
+    case memory_subsystem::scaled_bitmaps:  return "MEMORY_SCALED_BITMAPS";
+    case memory_subsystem::undo_history:    return "MEMORY_UNDO_HISTORY";
+    case memory_subsystem::output_models:   return "MEMORY_OUTPUT_MODELS";
+    case memory_subsystem::text_dialogs:    return "MEMORY_TEXT_DIALOGS";
+    }
+    return "";
+}
\ No newline at end of file
@@ -0,0 +1,25 @@
+#ifndef __MEMORY_BUDGET_H__
+#define __MEMORY_BUDGET_H__
+
+#include <cstdint>
+
+// Memory accounting of the editor, by subsystem. The numbers are approximate
+// heap usage kept up to date in perf_counters, so they are cheap to sample.
+enum class memory_subsystem {
+    page_rasters,   // rendered pages, in the page cache or on screen
+    buffer_pool,    // page buffers waiting to be reused
+    scaled_bitmaps, // the zoomed page of the image panels
+    undo_history,
+    output_models,  // nodes of the output dialog tree
+    text_dialogs,
+};
+
+constexpr int MEMORY_SUBSYSTEM_COUNT = static_cast<int>(memory_subsystem::text_dialogs) + 1;
+
+int64_t memory_usage(memory_subsystem subsystem);
+int64_t memory_usage_total();
+
+// translation key of the name of the subsystem
+const char *memory_subsystem_label(memory_subsystem subsystem);
+
+#endif
\ No newline at end of file
@@ -15,10 +15,12 @@ BEGIN_EVENT_TABLE(MovePageDialog, wxDialog)
     EVT_BUTTON(wxID_CANCEL, MovePageDialog::OnCancel)
 END_EVENT_TABLE()
 
-MovePageDialog::MovePageDialog(frame_editor *app, bls::layout_box *box)
-    : wxDialog(app, wxID_ANY, wxintl::translate("CHANGE_BOX_PAGE")), m_app(app), m_box(box)
+MovePageDialog::MovePageDialog(frame_editor *app, std::vector<bls::layout_box *> boxes)
+    : wxDialog(app, wxID_ANY, wxintl::translate("CHANGE_BOX_PAGE")), m_app(app), m_boxes(std::move(boxes))
 {
-    origpage = m_box->page;
+    for (auto *box : m_boxes) {
+        origpages.push_back(box->page);
+    }
 
     wxBoxSizer *sizer = new wxBoxSizer(wxVERTICAL);
 
@@ -40,8 +42,10 @@ MovePageDialog::MovePageDialog(frame_editor *app, bls::layout_box *box)
 }
 
 void MovePageDialog::OnPageSelect(wxCommandEvent &evt) {
-    m_box->page = m_page->GetValue();
-    m_app->setSelectedPage(m_box->page);
+    for (auto *box : m_boxes) {
+        box->page = m_page->GetValue();
+    }
+    m_app->setSelectedPage(m_page->GetValue());
 }
 
 void MovePageDialog::OnOK(wxCommandEvent &evt) {
@@ -50,7 +54,9 @@ void MovePageDialog::OnOK(wxCommandEvent &evt) {
 }
 
 void MovePageDialog::OnCancel(wxCommandEvent &evt) {
-    m_box->page = origpage;
-    m_app->setSelectedPage(origpage);
+    for (size_t i = 0; i < m_boxes.size(); ++i) {
+        m_boxes[i]->page = origpages[i];
+    }
+    m_app->setSelectedPage(origpages.front());
     evt.Skip();
 }
\ No newline at end of file
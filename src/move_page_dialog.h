@@ -3,19 +3,21 @@
 
 #include <wx/dialog.h>
 
+#include <vector>
+
 #include "layout.h"
 #include "editor.h"
 #include "page_ctl.h"
 
 class MovePageDialog : public wxDialog {
 public:
-    MovePageDialog(frame_editor *app, bls::layout_box *box);
+    MovePageDialog(frame_editor *app, std::vector<bls::layout_box *> boxes);
 
 private:
     frame_editor *m_app;
-    bls::layout_box *m_box;
+    std::vector<bls::layout_box *> m_boxes;
     PageCtrl *m_page;
-    int origpage;
+    std::vector<int> origpages;
 
     void OnPageSelect(wxCommandEvent &evt);
     void OnOK(wxCommandEvent &evt);
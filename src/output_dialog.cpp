@@ -3,9 +3,20 @@
 #include <wx/statline.h>
 #include <wx/filename.h>
 #include <wx/filefn.h>
+#include <wx/config.h>
+#include <wx/artprov.h>
+#include <wx/filedlg.h>
+#include <wx/msgdlg.h>
+
+#include <algorithm>
+#include <chrono>
+#include <format>
 
 #include "resources.h"
 #include "editor.h"
+#include "trace.h"
+#include "box_profile.h"
+#include "output_export.h"
 
 #include "parser.h"
 #include "reader.h"
@@ -17,6 +28,10 @@ enum {
     CTL_OUTPUT_PAGE,
     TOOL_UPDATE,
     TOOL_ABORT,
+    TOOL_PROFILE,
+    TOOL_EXPORT,
+    CTL_SEARCH,
+    CTL_PROFILE,
 };
 
 wxDEFINE_EVENT(wxEVT_COMMAND_READ_COMPLETE, wxThreadEvent);
@@ -24,12 +39,17 @@ wxDEFINE_EVENT(wxEVT_COMMAND_LAYOUT_ERROR, wxThreadEvent);
 
 BEGIN_EVENT_TABLE(output_dialog, wxDialog)
     EVT_MENU(TOOL_UPDATE, output_dialog::OnClickUpdate)
+    EVT_MENU(TOOL_PROFILE, output_dialog::OnToggleProfile)
+    EVT_MENU(TOOL_EXPORT, output_dialog::OnExport)
+    EVT_TEXT(CTL_SEARCH, output_dialog::OnSearch)
+    EVT_DATAVIEW_ITEM_ACTIVATED(CTL_PROFILE, output_dialog::OnProfileActivated)
     EVT_COMMAND(wxID_ANY, wxEVT_COMMAND_READ_COMPLETE, output_dialog::OnReadCompleted)
     EVT_COMMAND(wxID_ANY, wxEVT_COMMAND_LAYOUT_ERROR, output_dialog::OnLayoutError)
 END_EVENT_TABLE()
 
 DECLARE_RESOURCE(tool_reload_png)
 DECLARE_RESOURCE(tool_abort_png)
+DECLARE_RESOURCE(tool_test_png)
 
 output_dialog::output_dialog(frame_editor *parent) :
     wxDialog(parent, wxID_ANY, wxintl::translate("READER_DATA_OUTPUT"), wxDefaultPosition, wxDefaultSize, wxDEFAULT_DIALOG_STYLE | wxRESIZE_BORDER),
@@ -40,11 +60,25 @@ output_dialog::output_dialog(frame_editor *parent) :
     m_toolbar = new wxToolBar(this, wxID_ANY);
 
     m_toolbar->AddTool(TOOL_UPDATE, wxintl::translate("TOOL_UPDATE"), loadPNG(tool_reload_png), wxintl::translate("TOOL_UPDATE"));
+    m_toolbar->AddCheckTool(TOOL_PROFILE, wxintl::translate("TOOL_PROFILE_BOXES"), loadPNG(tool_test_png), wxNullBitmap, wxintl::translate("TOOL_PROFILE_BOXES_HINT"));
+    m_toolbar->ToggleTool(TOOL_PROFILE, wxConfig::Get()->ReadBool("ProfileBoxes", false));
+    m_toolbar->AddTool(TOOL_EXPORT, wxintl::translate("TOOL_EXPORT_OUTPUT"), wxArtProvider::GetBitmap(wxART_FILE_SAVE_AS, wxART_TOOLBAR), wxintl::translate("TOOL_EXPORT_OUTPUT"));
 
     m_toolbar->Realize();
     sizer->Add(m_toolbar, wxSizerFlags().Expand());
 
-    m_display = new wxDataViewCtrl(this, wxID_ANY, wxDefaultPosition, wxSize(500, 500));
+    wxBoxSizer *search_sizer = new wxBoxSizer(wxHORIZONTAL);
+    m_search = new wxSearchCtrl(this, CTL_SEARCH, wxEmptyString, wxDefaultPosition, wxSize(250, -1));
+    m_search->ShowCancelButton(true);
+    m_search->SetDescriptiveText(wxintl::translate("SEARCH_VARIABLES"));
+    search_sizer->Add(m_search, wxSizerFlags().Border(wxALL, 5));
+    m_search_status = new wxStaticText(this, wxID_ANY, wxEmptyString);
+    search_sizer->Add(m_search_status, wxSizerFlags(1).Center().Border(wxALL, 5));
+    sizer->Add(search_sizer, wxSizerFlags().Expand());
+
+    m_notebook = new wxNotebook(this, wxID_ANY);
+
+    m_display = new wxDataViewCtrl(m_notebook, wxID_ANY, wxDefaultPosition, wxSize(500, 500));
     m_display->AppendTextColumn(wxintl::translate("VARIABLE_NAME"), 0, wxDATAVIEW_CELL_INERT, 150, wxALIGN_LEFT);
     m_display->AppendTextColumn(wxintl::translate("VARIABLE_TYPE"), 1, wxDATAVIEW_CELL_INERT, 100, wxALIGN_LEFT);
     m_display->AppendTextColumn(wxintl::translate("VARIABLE_VALUE"), 2, wxDATAVIEW_CELL_INERT, 150, wxALIGN_LEFT);
@@ -52,7 +86,26 @@ output_dialog::output_dialog(frame_editor *parent) :
     m_model = new VariableTableModel;
     m_display->AssociateModel(m_model.get());
 
-    sizer->Add(m_display, wxSizerFlags(1).Expand());
+    m_notebook->AddPage(m_display, wxintl::translate("READER_OUTPUT_VALUES"));
+
+    m_profile_display = new wxDataViewCtrl(m_notebook, CTL_PROFILE, wxDefaultPosition, wxSize(500, 500));
+    auto add_profile_column = [&](const char *label, int col, int width, wxAlignment align) {
+        m_profile_display->AppendTextColumn(wxintl::translate(label), col, wxDATAVIEW_CELL_INERT, width, align, wxDATAVIEW_COL_SORTABLE | wxDATAVIEW_COL_RESIZABLE);
+    };
+    add_profile_column("PROFILE_BOX_NAME", PROFILE_COL_NAME, 120, wxALIGN_LEFT);
+    add_profile_column("PROFILE_PAGE", PROFILE_COL_PAGE, 50, wxALIGN_RIGHT);
+    add_profile_column("PROFILE_MODE", PROFILE_COL_MODE, 80, wxALIGN_LEFT);
+    add_profile_column("PROFILE_EXTRACT_MS", PROFILE_COL_EXTRACT, 80, wxALIGN_RIGHT);
+    add_profile_column("PROFILE_TEXT_BYTES", PROFILE_COL_TEXT, 70, wxALIGN_RIGHT);
+    add_profile_column("PROFILE_SCRIPT_LINES", PROFILE_COL_SCRIPT, 60, wxALIGN_RIGHT);
+    add_profile_column("PROFILE_GOTO_LABEL", PROFILE_COL_GOTO, 100, wxALIGN_LEFT);
+
+    m_profile_model = new BoxProfileModel;
+    m_profile_display->AssociateModel(m_profile_model.get());
+
+    m_notebook->AddPage(m_profile_display, wxintl::translate("READER_OUTPUT_PROFILE"));
+
+    sizer->Add(m_notebook, wxSizerFlags(1).Expand());
 
     SetSizerAndFit(sizer);
 
@@ -62,24 +115,98 @@ output_dialog::output_dialog(frame_editor *parent) :
 void output_dialog::OnClickUpdate(wxCommandEvent &) {
     if (m_thread) {
         m_reader.abort();
+        m_abort = true;
         m_toolbar->SetToolNormalBitmap(TOOL_UPDATE, loadPNG(tool_reload_png));
     } else {
         compileAndRead();
     }
 }
 
-reader_thread::reader_thread(output_dialog *parent, reader &m_reader, const layout_box_list &layout)
-    : parent(parent), m_reader(m_reader), m_layout(layout) {}
+void output_dialog::OnSearch(wxCommandEvent &) {
+    applySearch();
+}
+
+// every keystroke searches again, the index makes it cheap enough
+void output_dialog::applySearch() {
+    TRACE_SCOPE("applySearch");
+    std::string query(m_search->GetValue().ToUTF8());
+    size_t count = m_model->Search(query);
+    if (query.empty()) {
+        m_search_status->SetLabel(wxEmptyString);
+    } else if (count > MAX_SEARCH_RESULTS) {
+        m_search_status->SetLabel(wxintl::translate("SEARCH_TOO_MANY", MAX_SEARCH_RESULTS));
+    } else {
+        m_search_status->SetLabel(wxintl::translate("SEARCH_MATCHES", count));
+    }
+}
+
+void output_dialog::OnToggleProfile(wxCommandEvent &evt) {
+    wxConfig::Get()->Write("ProfileBoxes", evt.IsChecked());
+}
+
+void output_dialog::OnExport(wxCommandEvent &) {
+    if (m_thread) {
+        wxBell();
+        return;
+    }
+
+    wxFileDialog diag(this, wxintl::translate("EXPORT_OUTPUT_DIALOG"), wxEmptyString, "output.csv",
+        wxintl::to_wx(std::format("{} (*.csv)|*.csv|{} (*.json)|*.json|{} (*.jsonl)|*.jsonl",
+            intl::translate("CSV files"), intl::translate("JSON files"), intl::translate("JSON Lines files"))),
+        wxFD_SAVE | wxFD_OVERWRITE_PROMPT);
+
+    if (diag.ShowModal() == wxID_CANCEL)
+        return;
+
+    // the extension typed by the user wins over the selected filter
+    static constexpr export_format formats[] = {export_format::csv, export_format::json, export_format::jsonl};
+    std::filesystem::path filename = diag.GetPath().ToStdString();
+    export_format format = export_format_from_extension(filename).value_or(formats[std::clamp(diag.GetFilterIndex(), 0, 2)]);
+    try {
+        TRACE_SCOPE("export_output");
+        export_output(filename, format, m_reader.get_values());
+    } catch (const std::exception &error) {
+        wxMessageBox(error.what(), wxintl::translate("PROGRAM_NAME"), wxICON_ERROR);
+    }
+}
+
+void output_dialog::OnProfileActivated(wxDataViewEvent &evt) {
+    const box_profile_entry *entry = m_profile_model->GetEntry(evt.GetItem());
+    if (!entry || m_profile.layout_generation != parent->getLayoutGeneration()) {
+        wxBell();
+        return;
+    }
+    auto it = std::next(parent->layout.begin(), entry->index);
+    parent->setSelectedPage(entry->page);
+    parent->selectBox(&*it);
+}
+
+reader_thread::reader_thread(output_dialog *parent, reader &m_reader, const layout_box_list &layout, int layout_generation, bool profile)
+    : parent(parent), m_reader(m_reader), m_layout(layout), m_layout_generation(layout_generation), m_profile(profile) {}
 
 reader_thread::~reader_thread() {
     parent->m_thread = nullptr;
 }
 
 wxThread::ExitCode reader_thread::Entry() {
+    tracer::get().setThreadName("reader");
+    TRACE_SCOPE("reader_thread::Entry");
+
     try {
         if (m_layout.filename.empty()) m_layout.filename = std::filesystem::path(wxGetCwd().ToStdString()) / "tmp.bls";
         m_reader.add_layout(m_layout);
+        auto read_start = std::chrono::steady_clock::now();
         m_reader.start();
+        auto read_us = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - read_start).count();
+
+        // the boxes are timed again one by one after the read, so that profiling doesn't change the read itself
+        if (m_profile) {
+            box_profile profile = profile_boxes(parent->parent->getPdfDocument(), m_layout, parent->m_abort);
+            if (parent->m_abort) return (wxThread::ExitCode) 1;
+            profile.layout_generation = m_layout_generation;
+            profile.read_us = read_us;
+            parent->m_profile = std::move(profile);
+        }
         wxQueueEvent(parent, new wxThreadEvent(wxEVT_COMMAND_READ_COMPLETE));
 
         if (!m_reader.get_notes().empty()) {
@@ -111,10 +238,13 @@ void output_dialog::compileAndRead() {
     } else {
         m_toolbar->SetToolNormalBitmap(TOOL_UPDATE, loadPNG(tool_abort_png));
         m_model->ClearTables();
+        m_profile_model->SetEntries({});
+        m_profile = box_profile();
+        m_abort = false;
 
         m_reader.clear();
         m_reader.set_document(parent->getPdfDocument());
-        m_thread = new reader_thread(this, m_reader, parent->layout);
+        m_thread = new reader_thread(this, m_reader, parent->layout, parent->getLayoutGeneration(), m_toolbar->GetToolState(TOOL_PROFILE));
         if (m_thread->Run() != wxTHREAD_NO_ERROR) {
             delete m_thread;
             m_thread = nullptr;
@@ -136,11 +266,26 @@ void output_dialog::OnLayoutError(wxCommandEvent &evt) {
     error_dialog->ShowText(evt.GetString());
 }
 
+void output_dialog::releaseCollapsed() {
+    m_model->ReleaseCollapsed(m_display);
+}
+
 void output_dialog::OnReadCompleted(wxCommandEvent &evt) {
     m_toolbar->SetToolNormalBitmap(TOOL_UPDATE, loadPNG(tool_reload_png));
 
+    TRACE_SCOPE("OnReadCompleted");
     int i=1;
     for (const variable_map &table : m_reader.get_values()) {
         m_model->AddTable(wxintl::translate("TABLE_NUMBER", i++), table);
     }
+    m_model->BuildIndex();
+    if (!m_search->IsEmpty()) {
+        applySearch();
+    }
+    if (!m_profile.empty()) {
+        m_profile_model->SetEntries(m_profile.entries);
+        m_notebook->SetPageText(1, wxintl::translate("READER_OUTPUT_PROFILE_TIME", m_profile.read_us / 1000.0));
+    }
+    parent->setBoxProfile(m_profile);
+    parent->enforceMemoryBudget();
 }
\ No newline at end of file
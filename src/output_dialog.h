@@ -4,12 +4,18 @@
 #include <wx/dialog.h>
 #include <wx/combobox.h>
 #include <wx/thread.h>
+#include <wx/notebook.h>
+#include <wx/srchctrl.h>
+#include <wx/stattext.h>
+
+#include <atomic>
 
 #include "editor.h"
 #include "reader.h"
 #include "text_dialog.h"
 
 #include "variable_table_model.h"
+#include "box_profile_model.h"
 
 using namespace bls;
 
@@ -17,7 +23,7 @@ class output_dialog;
 
 class reader_thread : public wxThread {
 public:
-    reader_thread(output_dialog *parent, reader &m_reader, const layout_box_list &layout);
+    reader_thread(output_dialog *parent, reader &m_reader, const layout_box_list &layout, int layout_generation, bool profile);
     ~reader_thread();
 
 protected:
@@ -28,6 +34,8 @@ private:
     output_dialog *parent;
 
     layout_box_list m_layout;
+    int m_layout_generation;
+    bool m_profile;
 };
 
 class output_dialog : public wxDialog {
@@ -35,20 +43,40 @@ public:
     output_dialog(frame_editor *parent);
     void compileAndRead();
 
+    // frees the output nodes under the collapsed rows of the tree
+    void releaseCollapsed();
+
 private:
     frame_editor *parent;
 
     wxToolBar *m_toolbar;
 
+    wxSearchCtrl *m_search;
+    wxStaticText *m_search_status;
+
+    wxNotebook *m_notebook;
+
     wxDataViewCtrl *m_display;
     wxObjectDataPtr<VariableTableModel> m_model;
 
+    wxDataViewCtrl *m_profile_display;
+    wxObjectDataPtr<BoxProfileModel> m_profile_model;
+
     reader_thread *m_thread = nullptr;
     reader m_reader;
+
+    // written by the reader thread before it reports the read as complete
+    box_profile m_profile;
+    std::atomic<bool> m_abort = false;
     
     TextDialog *error_dialog;
 
     void OnClickUpdate(wxCommandEvent &evt);
+    void applySearch();
+    void OnToggleProfile(wxCommandEvent &evt);
+    void OnExport(wxCommandEvent &evt);
+    void OnSearch(wxCommandEvent &evt);
+    void OnProfileActivated(wxDataViewEvent &evt);
 
     void OnReadCompleted(wxCommandEvent &evt);
     void OnLayoutError(wxCommandEvent &evt);
@@ -0,0 +1,151 @@
+#include "output_export.h"
+
+#include <algorithm>
+#include <cctype>
+
+#include "json_utils.h"
+#include "trace.h"
+
+static void append_csv_field(std::string &out, std::string_view str) {
+    if (str.find_first_of(",\"\r\n") == std::string_view::npos) {
+        out.append(str);
+        return;
+    }
+    out += '"';
+    for (char c : str) {
+        if (c == '"') out += '"';
+        out += c;
+    }
+    out += '"';
+}
+
+std::optional<export_format> export_format_from_extension(const std::filesystem::path &filename) {
+    std::string ext = filename.extension().string();
+    std::ranges::transform(ext, ext.begin(), [](unsigned char c) { return char(std::tolower(c)); });
+    if (ext == ".csv") return export_format::csv;
+    if (ext == ".json") return export_format::json;
+    if (ext == ".jsonl") return export_format::jsonl;
+    return std::nullopt;
+}
+
+output_exporter::output_exporter(const std::filesystem::path &filename, export_format format)
+    : m_writer(filename), m_format(format)
+{
+    if (m_format == export_format::json) {
+        m_writer.write("[");
+    }
+}
+
+void output_exporter::add_columns(const variable_map &table) {
+    for (const auto &[key, val] : table) {
+        if (m_column_index.try_emplace(std::string(key), m_columns.size()).second) {
+            m_columns.emplace_back(key);
+        }
+    }
+}
+
+void output_exporter::write_table(const variable_map &table) {
+    TRACE_SCOPE("output_exporter::write_table");
+    switch (m_format) {
+    case export_format::csv:
+        if (m_tables == 0) write_csv_header();
+        write_csv_table(table);
+        break;
+    case export_format::json:
+        if (m_tables != 0) m_writer.buffer() += ',';
+        m_writer.buffer() += '\n';
+        write_json_table(table);
+        break;
+    case export_format::jsonl:
+        write_json_table(table);
+        m_writer.buffer() += '\n';
+        break;
+    }
+    ++m_tables;
+    m_writer.flush_if_full();
+}
+
+void output_exporter::commit() {
+    switch (m_format) {
+    case export_format::csv:
+        if (m_tables == 0) write_csv_header();
+        break;
+    case export_format::json:
+        m_writer.write("\n]\n");
+        break;
+    case export_format::jsonl:
+        break;
+    }
+    m_writer.commit();
+}
+
+void output_exporter::write_csv_header() {
+    std::string &out = m_writer.buffer();
+    out += "table";
+    for (const std::string &column : m_columns) {
+        out += ',';
+        append_csv_field(out, column);
+    }
+    out += "\r\n";
+}
+
+// array elements go on consecutive rows, the other values are repeated on each of them
+void output_exporter::write_csv_table(const variable_map &table) {
+    m_row.assign(m_columns.size(), nullptr);
+    size_t num_rows = 1;
+    for (const auto &[key, val] : table) {
+        auto it = m_column_index.find(std::string(key));
+        if (it == m_column_index.end()) continue;
+        m_row[it->second] = &val;
+        if (val.is_array()) {
+            num_rows = std::max(num_rows, val.as_array().size());
+        }
+    }
+
+    std::string &out = m_writer.buffer();
+    for (size_t row = 0; row < num_rows; ++row) {
+        out += std::to_string(m_tables + 1);
+        for (const variable *var : m_row) {
+            out += ',';
+            if (!var) continue;
+            if (!var->is_array()) {
+                append_csv_field(out, var->as_view());
+            } else if (const auto &arr = var->as_array(); row < arr.size()) {
+                append_csv_field(out, arr[row].as_view());
+            }
+        }
+        out += "\r\n";
+        m_writer.flush_if_full();
+    }
+}
+
+void output_exporter::write_json_table(const variable_map &table) {
+    std::string &out = m_writer.buffer();
+    out += '{';
+    bool first = true;
+    for (const auto &[key, val] : table) {
+        if (!first) out += ',';
+        first = false;
+        append_json_string(out, key);
+        out += ':';
+        write_json_value(val);
+        m_writer.flush_if_full();
+    }
+    out += '}';
+}
+
+void output_exporter::write_json_value(const variable &var) {
+    std::string &out = m_writer.buffer();
+    if (var.is_array()) {
+        out += '[';
+        bool first = true;
+        for (const variable &element : var.as_array()) {
+            if (!first) out += ',';
+            first = false;
+            write_json_value(element);
+        }
+        out += ']';
+    } else {
+        append_json_string(out, var.as_view());
+    }
+}
\ No newline at end of file
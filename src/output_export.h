@@ -0,0 +1,67 @@
+#ifndef __OUTPUT_EXPORT_H__
+#define __OUTPUT_EXPORT_H__
+
+#include <filesystem>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "reader.h"
+#include "file_utils.h"
+
+using namespace bls;
+
+enum class export_format {
+    csv,    // a row per table, or per array element when the table has arrays
+    json,   // an array with an object per table
+    jsonl,  // an object per table, one per line
+};
+
+// the format of a .csv, .json or .jsonl file, case insensitive, or nothing for other extensions
+std::optional<export_format> export_format_from_extension(const std::filesystem::path &filename);
+
+// Writes the tables of a read straight from the variables to a file through a buffer.
+// Values are written as the strings the output dialog shows, arrays as JSON arrays.
+// Throws std::runtime_error, the file is only replaced by commit().
+class output_exporter {
+public:
+    output_exporter(const std::filesystem::path &filename, export_format format);
+
+    // csv only: every key of every table is a column, so they must all be added before the first table is written
+    void add_columns(const variable_map &table);
+
+    void write_table(const variable_map &table);
+    void commit();
+
+private:
+    void write_csv_header();
+    void write_csv_table(const variable_map &table);
+    void write_json_table(const variable_map &table);
+    void write_json_value(const variable &var);
+
+private:
+    atomic_file_writer m_writer;
+    export_format m_format;
+    size_t m_tables = 0;
+
+    std::vector<std::string> m_columns;
+    std::unordered_map<std::string, size_t> m_column_index;
+    std::vector<const variable *> m_row;
+};
+
+template<typename Tables>
+void export_output(const std::filesystem::path &filename, export_format format, const Tables &tables) {
+    output_exporter exporter(filename, format);
+    if (format == export_format::csv) {
+        for (const variable_map &table : tables) {
+            exporter.add_columns(table);
+        }
+    }
+    for (const variable_map &table : tables) {
+        exporter.write_table(table);
+    }
+    exporter.commit();
+}
+
+#endif
\ No newline at end of file
@@ -0,0 +1,54 @@
+#include "page_cache.h"
+
+#include <algorithm>
+
+#include "image_convert.h"
+#include "perf_counters.h"
+
+constexpr size_t MAX_CACHED_PAGES = 6;
+
+std::shared_ptr<const page_raster> page_cache::find(int page) {
+    auto it = std::ranges::find(m_entries, page, &entry::page);
+    if (it == m_entries.end()) {
+        perf_counters::get().page_cache_misses.fetch_add(1, std::memory_order_relaxed);
+        return nullptr;
+    }
+    perf_counters::get().page_cache_hits.fetch_add(1, std::memory_order_relaxed);
+    m_entries.splice(m_entries.begin(), m_entries, it);
+    return it->raster;
+}
+
+bool page_cache::contains(int page) const {
+    return std::ranges::find(m_entries, page, &entry::page) != m_entries.end();
+}
+
+std::shared_ptr<const page_raster> page_cache::insert(int page, page_raster &&raster) {
+    std::erase_if(m_entries, [&](const entry &e) { return e.page == page; });
+    auto &ret = m_entries.emplace_front(entry{page, std::make_shared<const page_raster>(std::move(raster))}).raster;
+    while (m_entries.size() > MAX_CACHED_PAGES) {
+        m_entries.pop_back();
+    }
+    return ret;
+}
+
+void page_cache::to_grayscale() {
+    for (entry &e : m_entries) {
+        if (e.raster->channels() != 1) {
+            e.raster = std::make_shared<const page_raster>(::to_grayscale(*e.raster));
+        }
+    }
+}
+
+bool page_cache::evict_oldest(int keep_page) {
+    for (auto it = m_entries.rbegin(); it != m_entries.rend(); ++it) {
+        if (it->page != keep_page) {
+            m_entries.erase(std::next(it).base());
+            return true;
+        }
+    }
+    return false;
+}
+
+void page_cache::clear() {
+    m_entries.clear();
+}
\ No newline at end of file
@@ -0,0 +1,35 @@
+#ifndef __PAGE_CACHE_H__
+#define __PAGE_CACHE_H__
+
+#include <list>
+#include <memory>
+
+#include "page_raster.h"
+
+// Most recently viewed page rasters of the open document, all in the same rotation
+class page_cache {
+public:
+    std::shared_ptr<const page_raster> find(int page);
+
+    // unlike find, leaves the order of the pages and the hit counters as they are
+    bool contains(int page) const;
+    std::shared_ptr<const page_raster> insert(int page, page_raster &&raster);
+
+    // drops the color channels of every cached page
+    void to_grayscale();
+
+    // drops the least recently viewed page other than keep_page, false if there is none
+    bool evict_oldest(int keep_page);
+
+    void clear();
+
+private:
+    struct entry {
+        int page;
+        std::shared_ptr<const page_raster> raster;
+    };
+
+    std::list<entry> m_entries;
+};
+
+#endif
\ No newline at end of file
@@ -0,0 +1,82 @@
+#ifndef __PAGE_RASTER_H__
+#define __PAGE_RASTER_H__
+
+#include <cstdint>
+#include <utility>
+
+#include "pdf_document.h"
+#include "buffer_pool.h"
+#include "perf_counters.h"
+
+// Owning view of an interleaved page bitmap.
+// Adopts the buffer released by pdf_image so that the rendered page is never copied,
+// buffers are handed back to the buffer_pool when the raster is destroyed.
+class page_raster {
+public:
+    page_raster() = default;
+
+    page_raster(int width, int height, int channels)
+        : m_width(width), m_height(height), m_channels(channels)
+    {
+        m_data = buffer_pool::get().acquire(size_bytes(), m_capacity);
+        perf_counters::get().raster_bytes.fetch_add(m_capacity, std::memory_order_relaxed);
+    }
+
+    explicit page_raster(bls::pdf_image &&image)
+        : m_width(image.width()), m_height(image.height()), m_channels(3)
+    {
+        m_capacity = size_bytes();
+        m_data = image.release();
+        perf_counters::get().raster_bytes.fetch_add(m_capacity, std::memory_order_relaxed);
+    }
+
+    page_raster(const page_raster &) = delete;
+    page_raster(page_raster &&other) noexcept {
+        swap(other);
+    }
+
+    page_raster &operator = (const page_raster &) = delete;
+    page_raster &operator = (page_raster &&other) noexcept {
+        page_raster(std::move(other)).swap(*this);
+        return *this;
+    }
+
+    ~page_raster() {
+        if (m_data) {
+            perf_counters::get().raster_bytes.fetch_sub(m_capacity, std::memory_order_relaxed);
+        }
+        buffer_pool::get().release(m_data, m_capacity);
+    }
+
+    void swap(page_raster &other) noexcept {
+        std::swap(m_width, other.m_width);
+        std::swap(m_height, other.m_height);
+        std::swap(m_channels, other.m_channels);
+        std::swap(m_data, other.m_data);
+        std::swap(m_capacity, other.m_capacity);
+    }
+
+    explicit operator bool() const {
+        return m_data != nullptr;
+    }
+
+    int width() const { return m_width; }
+    int height() const { return m_height; }
+    int channels() const { return m_channels; }
+
+    size_t stride() const { return size_t(m_width) * m_channels; }
+    size_t size_bytes() const { return stride() * m_height; }
+    size_t capacity() const { return m_capacity; }
+
+    uint8_t *data() { return m_data; }
+    const uint8_t *data() const { return m_data; }
+
+private:
+    int m_width = 0;
+    int m_height = 0;
+    int m_channels = 0;
+    uint8_t *m_data = nullptr;
+    size_t m_capacity = 0;
+};
+
+#endif
\ No newline at end of file
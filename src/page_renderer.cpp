@@ -0,0 +1,131 @@
+#include "page_renderer.h"
+
+#include "image_convert.h"
+#include "render_cache.h"
+#include "trace.h"
+#include "perf_counters.h"
+
+wxDEFINE_EVENT(wxEVT_COMMAND_PAGE_RENDERED, wxThreadEvent);
+
+page_render_thread::page_render_thread(wxEvtHandler *parent, std::shared_ptr<page_render_request> request)
+    : wxThread(wxTHREAD_JOINABLE), parent(parent), m_request(std::move(request)) {}
+
+wxThread::ExitCode page_render_thread::Entry() {
+    tracer::get().setThreadName("page_renderer");
+
+    std::filesystem::path pdf_filename;
+    uint64_t pdf_hash;
+    int generation;
+    {
+        std::scoped_lock lock(m_request->mutex);
+        pdf_filename = m_request->pdf_filename;
+        pdf_hash = m_request->pdf_hash;
+        generation = m_request->generation;
+    }
+
+    // a document that fails to open still answers every request, so the editor hears about it
+    pdf_document doc;
+    std::string open_error;
+    try {
+        doc.open(pdf_filename.string());
+    } catch (const std::exception &error) {
+        open_error = error.what();
+    }
+
+    auto post_result = [&](page_render_result result) {
+        auto *evt = new wxThreadEvent(wxEVT_COMMAND_PAGE_RENDERED);
+        evt->SetPayload(std::move(result));
+        wxQueueEvent(parent, evt);
+    };
+
+    while (true) {
+        int page, rotation;
+        bool grayscale;
+        {
+            std::unique_lock lock(m_request->mutex);
+            m_request->cond.wait(lock, [&]{ return m_request->stopped || m_request->pending; });
+            if (m_request->stopped) break;
+            m_request->pending = false;
+            page = m_request->page;
+            rotation = m_request->rotation;
+            grayscale = m_request->grayscale;
+        }
+
+        if (!open_error.empty()) {
+            post_result(page_render_result{page, rotation, grayscale, false, generation, nullptr, open_error});
+            continue;
+        }
+
+        render_key key{pdf_hash, page, rotation, 0, grayscale ? 1 : 3};
+        page_raster raster;
+        bool from_disk = false;
+        if (pdf_hash) {
+            raster = render_cache::get().load(key);
+            from_disk = bool(raster);
+        }
+        if (!raster) {
+            try {
+                TRACE_SCOPE("render_page");
+                perf_timer timer(perf_counters::get().last_render_us);
+                raster = page_raster(doc.render_page(page, rotation));
+            } catch (const std::exception &error) {
+                post_result(page_render_result{page, rotation, grayscale, false, generation, nullptr, error.what()});
+                continue;
+            }
+            if (grayscale) {
+                raster = to_grayscale(raster);
+            }
+        }
+
+        post_result(page_render_result{page, rotation, grayscale, from_disk, generation,
+            std::make_shared<page_raster>(std::move(raster))});
+    }
+    return (wxThread::ExitCode) 0;
+}
+
+page_renderer::~page_renderer() {
+    close();
+}
+
+void page_renderer::open(const std::filesystem::path &pdf_filename, uint64_t pdf_hash) {
+    close();
+
+    m_request = std::make_shared<page_render_request>();
+    m_request->pdf_filename = pdf_filename;
+    m_request->pdf_hash = pdf_hash;
+    m_request->generation = ++m_generation;
+
+    m_thread = new page_render_thread(parent, m_request);
+    if (m_thread->Run() != wxTHREAD_NO_ERROR) {
+        delete m_thread;
+        m_thread = nullptr;
+    }
+}
+
+void page_renderer::close() {
+    if (m_request) {
+        {
+            std::scoped_lock lock(m_request->mutex);
+            m_request->stopped = true;
+        }
+        m_request->cond.notify_all();
+    }
+    if (m_thread) {
+        m_thread->Wait();
+        delete m_thread;
+        m_thread = nullptr;
+    }
+    m_request.reset();
+}
+
+void page_renderer::request(int page, int rotation, bool grayscale) {
+    if (!m_request) return;
+    {
+        std::scoped_lock lock(m_request->mutex);
+        m_request->page = page;
+        m_request->rotation = rotation;
+        m_request->grayscale = grayscale;
+        m_request->pending = true;
+    }
+    m_request->cond.notify_one();
+}
\ No newline at end of file
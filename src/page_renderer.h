@@ -0,0 +1,82 @@
+#ifndef __PAGE_RENDERER_H__
+#define __PAGE_RENDERER_H__
+
+#include <wx/thread.h>
+#include <wx/event.h>
+
+#include <mutex>
+#include <condition_variable>
+#include <filesystem>
+#include <memory>
+#include <string>
+
+#include "page_raster.h"
+
+using namespace bls;
+
+wxDECLARE_EVENT(wxEVT_COMMAND_PAGE_RENDERED, wxThreadEvent);
+
+struct page_render_result {
+    int page;
+    int rotation;
+    bool grayscale;
+    bool from_disk;
+    int generation;
+    std::shared_ptr<page_raster> raster;
+
+    // set when the page could not be rendered, the raster is empty then
+    std::string error;
+};
+
+// Single slot mailbox between the editor and the render thread.
+// A new request replaces the pending one, so only the latest target is ever rendered.
+struct page_render_request {
+    std::mutex mutex;
+    std::condition_variable cond;
+    bool pending = false;
+    bool stopped = false;
+
+    int page = 0;
+    int rotation = 0;
+    bool grayscale = false;
+
+    std::filesystem::path pdf_filename;
+    uint64_t pdf_hash = 0;
+    int generation = 0;
+};
+
+class page_render_thread : public wxThread {
+public:
+    page_render_thread(wxEvtHandler *parent, std::shared_ptr<page_render_request> request);
+
+protected:
+    virtual ExitCode Entry() override;
+
+private:
+    wxEvtHandler *parent;
+    std::shared_ptr<page_render_request> m_request;
+};
+
+class page_renderer {
+public:
+    page_renderer(wxEvtHandler *parent) : parent(parent) {}
+    ~page_renderer();
+
+    void open(const std::filesystem::path &pdf_filename, uint64_t pdf_hash);
+    void close();
+
+    void request(int page, int rotation, bool grayscale);
+
+    int generation() const {
+        return m_generation;
+    }
+
+private:
+    wxEvtHandler *parent;
+
+    std::shared_ptr<page_render_request> m_request;
+    page_render_thread *m_thread = nullptr;
+    int m_generation = 0;
+};
+
+#endif
\ No newline at end of file
@@ -0,0 +1,52 @@
+#ifndef __PERF_COUNTERS_H__
+#define __PERF_COUNTERS_H__
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstddef>
+
+// Counters kept up to date by the subsystems of the editor, sampled by the performance overlay.
+// They are relaxed atomics, so the render threads update them as they go at no real cost.
+struct perf_counters {
+    static perf_counters &get() {
+        static perf_counters counters;
+        return counters;
+    }
+
+    std::atomic<int64_t> last_render_us = 0;
+    std::atomic<int64_t> last_scale_us = 0;
+    std::atomic<int64_t> last_paint_us = 0;
+
+    std::atomic<uint64_t> page_cache_hits = 0;
+    std::atomic<uint64_t> page_cache_misses = 0;
+    std::atomic<uint64_t> render_cache_hits = 0;
+    std::atomic<uint64_t> render_cache_misses = 0;
+
+    // bytes held by each subsystem, see memory_budget.h
+    std::atomic<int64_t> raster_bytes = 0;
+    std::atomic<int64_t> scaled_bitmap_bytes = 0;
+    std::atomic<int64_t> history_bytes = 0;
+    std::atomic<int64_t> output_model_bytes = 0;
+    std::atomic<int64_t> text_dialog_bytes = 0;
+};
+
+// stores the duration of its scope in microseconds into a counter
+class perf_timer {
+public:
+    explicit perf_timer(std::atomic<int64_t> &counter)
+        : m_counter(counter), m_start(std::chrono::steady_clock::now()) {}
+
+    ~perf_timer() {
+        m_counter.store(std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - m_start).count(), std::memory_order_relaxed);
+    }
+
+    perf_timer(const perf_timer &) = delete;
+    perf_timer &operator = (const perf_timer &) = delete;
+
+private:
+    std::atomic<int64_t> &m_counter;
+    std::chrono::steady_clock::time_point m_start;
+};
+
+#endif
\ No newline at end of file
@@ -0,0 +1,249 @@
+#include "render_cache.h"
+
+#include <wx/wfstream.h>
+#include <wx/zstream.h>
+#include <wx/log.h>
+
+#include <vector>
+#include <algorithm>
+#include <format>
+
+#include "file_hash.h"
+#include "perf_counters.h"
+#include "buffer_pool.h"
+
+constexpr uint32_t RENDER_CACHE_MAGIC = 0x52534c42; // "BLSR"
+constexpr uint32_t RENDER_CACHE_VERSION = 1;
+constexpr size_t MAX_PENDING_WRITES = 4;
+
+struct render_cache_header {
+    uint32_t magic;
+    uint32_t version;
+    int32_t width;
+    int32_t height;
+    int32_t channels;
+};
+
+render_cache &render_cache::get() {
+    static render_cache cache;
+    return cache;
+}
+
+// the queued rasters give their buffers back to the pool, which must be built first to be destroyed last
+render_cache::render_cache() {
+    buffer_pool::get();
+}
+
+render_cache::~render_cache() {
+    shutdown();
+}
+
+void render_cache::shutdown() {
+    std::deque<std::pair<render_key, std::shared_ptr<const page_raster>>> dropped;
+    {
+        std::scoped_lock lock(m_mutex);
+        m_stopped = true;
+        dropped.swap(m_pending);
+    }
+    m_writer_cond.notify_all();
+    if (m_writer.joinable()) {
+        m_writer.join();
+    }
+}
+
+void render_cache::setDirectory(const std::filesystem::path &directory) {
+    std::scoped_lock lock(m_mutex);
+    m_directory = directory;
+    m_scanned = false;
+    m_total_bytes = 0;
+}
+
+void render_cache::setMaxBytes(uintmax_t max_bytes) {
+    std::scoped_lock lock(m_mutex);
+    m_max_bytes = max_bytes;
+}
+
+std::filesystem::path render_cache::getFilename(const render_key &key) const {
+    return m_directory / hash_to_hex(key.pdf_hash)
+        / std::format("{}_{}_{}_{}.bin", key.page, key.rotation, key.size, key.channels);
+}
+
+page_raster render_cache::load(const render_key &key) {
+    page_raster raster = loadFile(key);
+    (raster ? perf_counters::get().render_cache_hits : perf_counters::get().render_cache_misses).fetch_add(1, std::memory_order_relaxed);
+    return raster;
+}
+
+page_raster render_cache::loadFile(const render_key &key) {
+    std::filesystem::path filename;
+    {
+        std::scoped_lock lock(m_mutex);
+        if (m_directory.empty()) return {};
+        filename = getFilename(key);
+    }
+
+    wxLogNull no_log;
+    std::error_code ec;
+    if (!std::filesystem::exists(filename, ec)) return {};
+
+    wxFileInputStream file(filename.string());
+    if (!file.IsOk()) return {};
+
+    render_cache_header header;
+    if (!file.ReadAll(&header, sizeof(header))
+        || header.magic != RENDER_CACHE_MAGIC || header.version != RENDER_CACHE_VERSION
+        || header.width <= 0 || header.height <= 0 || header.channels != key.channels)
+    {
+        return {};
+    }
+
+    page_raster raster(header.width, header.height, header.channels);
+    wxZlibInputStream zlib(file);
+    if (!zlib.ReadAll(raster.data(), raster.size_bytes())) {
+        return {};
+    }
+
+    // undo the row delta filter
+    for (int y = 0; y < raster.height(); ++y) {
+        uint8_t *row = raster.data() + y * raster.stride();
+        for (size_t i = raster.channels(); i < raster.stride(); ++i) {
+            row[i] += row[i - raster.channels()];
+        }
+    }
+
+    // the modification time is the LRU stamp
+    std::filesystem::last_write_time(filename, std::filesystem::file_time_type::clock::now(), ec);
+    return raster;
+}
+
+void render_cache::store(const render_key &key, const page_raster &raster) {
+    std::filesystem::path filename;
+    {
+        std::scoped_lock lock(m_mutex);
+        if (m_directory.empty() || !raster) return;
+        filename = getFilename(key);
+    }
+
+    wxLogNull no_log;
+    std::error_code ec;
+    std::filesystem::create_directories(filename.parent_path(), ec);
+
+    auto tmp_filename = filename;
+    tmp_filename += std::format(".{}.tmp", std::hash<std::thread::id>{}(std::this_thread::get_id()));
+    {
+        wxFileOutputStream file(tmp_filename.string());
+        if (!file.IsOk()) return;
+
+        render_cache_header header{RENDER_CACHE_MAGIC, RENDER_CACHE_VERSION, raster.width(), raster.height(), raster.channels()};
+        file.Write(&header, sizeof(header));
+
+        wxZlibOutputStream zlib(file, 1);
+        std::vector<uint8_t> row(raster.stride());
+        for (int y = 0; y < raster.height(); ++y) {
+            const uint8_t *src = raster.data() + y * raster.stride();
+            for (size_t i = 0; i < raster.stride(); ++i) {
+                row[i] = i < size_t(raster.channels()) ? src[i] : src[i] - src[i - raster.channels()];
+            }
+            zlib.Write(row.data(), row.size());
+        }
+        if (!zlib.Close() || !file.Close()) {
+            std::filesystem::remove(tmp_filename, ec);
+            return;
+        }
+    }
+
+    std::filesystem::rename(tmp_filename, filename, ec);
+    if (ec) {
+        std::filesystem::remove(tmp_filename, ec);
+        return;
+    }
+    addBytes(std::filesystem::file_size(filename, ec));
+}
+
+void render_cache::storeAsync(const render_key &key, std::shared_ptr<const page_raster> raster) {
+    std::scoped_lock lock(m_mutex);
+    if (m_directory.empty() || m_stopped) return;
+    if (!m_writer.joinable()) {
+        m_writer = std::thread(&render_cache::writerLoop, this);
+    }
+    // pages flipped faster than they can be written are just not cached
+    if (m_pending.size() < MAX_PENDING_WRITES) {
+        m_pending.emplace_back(key, std::move(raster));
+        m_writer_cond.notify_one();
+    }
+}
+
+void render_cache::writerLoop() {
+    while (true) {
+        std::pair<render_key, std::shared_ptr<const page_raster>> item;
+        {
+            std::unique_lock lock(m_mutex);
+            m_writer_cond.wait(lock, [&]{ return m_stopped || !m_pending.empty(); });
+            if (m_stopped) break;
+            item = std::move(m_pending.front());
+            m_pending.pop_front();
+        }
+        store(item.first, *item.second);
+    }
+}
+
+void render_cache::addBytes(uintmax_t bytes) {
+    bool over_budget;
+    {
+        std::scoped_lock lock(m_mutex);
+        if (!m_scanned) {
+            m_scanned = true;
+            m_total_bytes = 0;
+            std::error_code ec;
+            for (auto &entry : std::filesystem::recursive_directory_iterator(m_directory, ec)) {
+                if (entry.is_regular_file(ec)) {
+                    m_total_bytes += entry.file_size(ec);
+                }
+            }
+        } else {
+            m_total_bytes += bytes;
+        }
+        over_budget = m_total_bytes > m_max_bytes;
+    }
+    if (over_budget) {
+        evict();
+    }
+}
+
+// deletes the least recently used files until the cache is a tenth under its cap
+void render_cache::evict() {
+    std::filesystem::path directory;
+    uintmax_t target;
+    {
+        std::scoped_lock lock(m_mutex);
+        directory = m_directory;
+        target = m_max_bytes - m_max_bytes / 10;
+    }
+
+    struct cache_file {
+        std::filesystem::path filename;
+        std::filesystem::file_time_type time;
+        uintmax_t size;
+    };
+    std::vector<cache_file> files;
+    uintmax_t total = 0;
+
+    std::error_code ec;
+    for (auto &entry : std::filesystem::recursive_directory_iterator(directory, ec)) {
+        if (entry.is_regular_file(ec)) {
+            files.push_back({entry.path(), entry.last_write_time(ec), entry.file_size(ec)});
+            total += files.back().size;
+        }
+    }
+    std::ranges::sort(files, {}, &cache_file::time);
+
+    for (const cache_file &file : files) {
+        if (total <= target) break;
+        if (std::filesystem::remove(file.filename, ec)) {
+            total -= file.size;
+        }
+    }
+
+    std::scoped_lock lock(m_mutex);
+    m_total_bytes = total;
+}
\ No newline at end of file
@@ -0,0 +1,67 @@
+#ifndef __RENDER_CACHE_H__
+#define __RENDER_CACHE_H__
+
+#include <filesystem>
+#include <mutex>
+#include <thread>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+
+#include "page_raster.h"
+
+struct render_key {
+    uint64_t pdf_hash;
+    int page;
+    int rotation;
+    int size;       // longest side of a downscaled render, 0 for full pages
+    int channels;
+};
+
+// On-disk cache of rendered pages and thumbnails, keyed by PDF content hash.
+// Pixels are stored row-delta filtered and deflated, the least recently used
+// files are evicted when the cache grows over its size cap.
+class render_cache {
+public:
+    static render_cache &get();
+
+    ~render_cache();
+
+    void setDirectory(const std::filesystem::path &directory);
+    void setMaxBytes(uintmax_t max_bytes);
+
+    // returns an empty raster on a miss
+    page_raster load(const render_key &key);
+
+    void store(const render_key &key, const page_raster &raster);
+
+    // stores the raster from a background thread, the raster must not be modified afterwards
+    void storeAsync(const render_key &key, std::shared_ptr<const page_raster> raster);
+
+    // drops the writes that are still queued and waits for the writer thread,
+    // so that no raster outlives the application. Later stores are ignored.
+    void shutdown();
+
+private:
+    render_cache();
+
+    page_raster loadFile(const render_key &key);
+    std::filesystem::path getFilename(const render_key &key) const;
+    void addBytes(uintmax_t bytes);
+    void evict();
+    void writerLoop();
+
+private:
+    std::mutex m_mutex;
+    std::filesystem::path m_directory;
+    uintmax_t m_max_bytes = 512 * 1024 * 1024;
+    uintmax_t m_total_bytes = 0;
+    bool m_scanned = false;
+
+    std::thread m_writer;
+    std::condition_variable m_writer_cond;
+    std::deque<std::pair<render_key, std::shared_ptr<const page_raster>>> m_pending;
+    bool m_stopped = false;
+};
+
+#endif
\ No newline at end of file
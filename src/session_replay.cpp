@@ -0,0 +1,123 @@
+#include "session_replay.h"
+
+#include <algorithm>
+#include <format>
+#include <fstream>
+#include <iostream>
+
+#include "editor.h"
+#include "json_utils.h"
+
+// a page that never finishes rendering must not stall the replay
+constexpr int EVENT_TIMEOUT_MS = 10000;
+
+session_replay::session_replay(frame_editor *editor, input_session session, const wxString &report_filename)
+    : m_editor(editor), m_session(std::move(session)), m_report_filename(report_filename), m_timeout(this)
+{
+    m_latencies.resize(static_cast<size_t>(input_event_type::mouse_up) + 1);
+    Bind(wxEVT_TIMER, &session_replay::OnTimeout, this);
+}
+
+void session_replay::start() {
+    m_next = 0;
+    m_replay_start = std::chrono::steady_clock::now();
+    CallAfter(&session_replay::step);
+}
+
+void session_replay::step() {
+    if (m_next >= m_session.events.size()) {
+        writeReport();
+        m_editor->endReplay();
+        return;
+    }
+
+    m_event_start = std::chrono::steady_clock::now();
+    if (m_editor->replayEvent(m_session.events[m_next])) {
+        complete();
+    } else {
+        m_waiting = true;
+        m_timeout.StartOnce(EVENT_TIMEOUT_MS);
+    }
+}
+
+void session_replay::complete() {
+    auto latency = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - m_event_start).count();
+    m_latencies[static_cast<size_t>(m_session.events[m_next].type)].push_back(latency);
+    m_waiting = false;
+    ++m_next;
+
+    // the events queued by the last one, like repaints of other windows, are handled before the next
+    CallAfter(&session_replay::step);
+}
+
+void session_replay::pageShown() {
+    if (m_waiting) {
+        m_timeout.Stop();
+        complete();
+    }
+}
+
+void session_replay::pageFailed(const std::string &error) {
+    if (m_waiting) {
+        m_timeout.Stop();
+        m_waiting = false;
+        ++m_errors;
+        m_last_error = error;
+        ++m_next;
+        CallAfter(&session_replay::step);
+    }
+}
+
+void session_replay::OnTimeout(wxTimerEvent &evt) {
+    if (m_waiting) {
+        m_waiting = false;
+        ++m_timeouts;
+        ++m_next;
+        CallAfter(&session_replay::step);
+    }
+}
+
+static int64_t percentile(const std::vector<int64_t> &sorted, int pct) {
+    size_t rank = (sorted.size() * pct + 99) / 100;
+    return sorted[std::max<size_t>(rank, 1) - 1];
+}
+
+void session_replay::writeReport() {
+    auto total_us = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - m_replay_start).count();
+
+    std::string out = "{\"version\":1,\"layout\":";
+    append_json_string(out, m_session.layout_filename.string());
+    out += ",\"pdf\":";
+    append_json_string(out, m_session.pdf_filename.string());
+    out += std::format(",\"events\":{},\"timeouts\":{},\"errors\":{},",
+        m_session.events.size(), m_timeouts, m_errors);
+    if (!m_last_error.empty()) {
+        out += "\"last_error\":";
+        append_json_string(out, m_last_error);
+        out += ',';
+    }
+    out += std::format("\"total_us\":{},\"latency\":{{", total_us);
+
+    bool first = true;
+    for (size_t i = 0; i < m_latencies.size(); ++i) {
+        auto &values = m_latencies[i];
+        if (values.empty()) continue;
+        std::ranges::sort(values);
+        int64_t sum = 0;
+        for (int64_t value : values) sum += value;
+
+        if (!first) out += ',';
+        first = false;
+        append_json_string(out, input_event_name(static_cast<input_event_type>(i)));
+        out += std::format(":{{\"count\":{},\"mean_us\":{},\"p50_us\":{},\"p90_us\":{},\"p99_us\":{},\"max_us\":{}}}",
+            values.size(), sum / int64_t(values.size()),
+            percentile(values, 50), percentile(values, 90), percentile(values, 99), values.back());
+    }
+    out += "}}\n";
+
+    if (m_report_filename.empty()) {
+        std::cout << out << std::flush;
+    } else {
+        std::ofstream(m_report_filename.ToStdString(), std::ios::out | std::ios::trunc) << out;
+    }
+}
\ No newline at end of file
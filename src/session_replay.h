@@ -0,0 +1,54 @@
+#ifndef __SESSION_REPLAY_H__
+#define __SESSION_REPLAY_H__
+
+#include <wx/event.h>
+#include <wx/timer.h>
+
+#include <chrono>
+#include <vector>
+#include <string>
+
+#include "input_session.h"
+
+// Feeds a recorded session back into the editor as fast as it can process it,
+// and measures the latency of every event until its result is painted.
+// A page flip is complete once the rendered page is on screen, not the preview.
+class session_replay : public wxEvtHandler {
+public:
+    session_replay(class frame_editor *editor, input_session session, const wxString &report_filename);
+
+    void start();
+
+    // called by the editor when the page of the last page_select event is shown
+    void pageShown();
+
+    // called by the editor when that page could not be rendered, the event counts as an error
+    void pageFailed(const std::string &error);
+
+private:
+    void step();
+    void complete();
+    void writeReport();
+
+    void OnTimeout(wxTimerEvent &evt);
+
+private:
+    class frame_editor *m_editor;
+    input_session m_session;
+    wxString m_report_filename;
+
+    size_t m_next = 0;
+    bool m_waiting = false;
+    size_t m_timeouts = 0;
+    size_t m_errors = 0;
+    std::string m_last_error;
+    std::chrono::steady_clock::time_point m_event_start;
+    std::chrono::steady_clock::time_point m_replay_start;
+
+    // latencies in microseconds, indexed by event type
+    std::vector<std::vector<int64_t>> m_latencies;
+
+    wxTimer m_timeout;
+};
+
+#endif
\ No newline at end of file
@@ -8,6 +8,7 @@
 #include <wx/button.h>
 
 #include "wxintl.h"
+#include "perf_counters.h"
 
 class TextDialog : public wxDialog {
 public:
@@ -22,15 +23,36 @@ public:
 
         sizer->Add(new wxButton(this, wxID_OK, wxintl::translate("OK")), wxSizerFlags().Center().Border(wxALL, 5));
         SetSizer(sizer);
+
+        // the text is only kept while the dialog is shown
+        Bind(wxEVT_SHOW, [this](wxShowEvent &evt) {
+            if (!evt.IsShown()) {
+                m_text_ctl->Clear();
+                setTextBytes(0);
+            }
+            evt.Skip();
+        });
+    }
+
+    ~TextDialog() {
+        setTextBytes(0);
     }
 
     void ShowText(const wxString &message) {
         m_text_ctl->SetValue(message);
+        setTextBytes(int64_t(message.length() * sizeof(wxStringCharType)));
         Show();
     }
 
+private:
+    void setTextBytes(int64_t bytes) {
+        perf_counters::get().text_dialog_bytes += bytes - m_text_bytes;
+        m_text_bytes = bytes;
+    }
+
 private:
     wxTextCtrl *m_text_ctl;
+    int64_t m_text_bytes = 0;
 };
 
 #endif
\ No newline at end of file
@@ -0,0 +1,309 @@
+#include "thumbnail_panel.h"
+
+#include <wx/dcclient.h>
+#include <wx/settings.h>
+
+#include <cstring>
+
+#include "editor.h"
+#include "page_raster.h"
+#include "image_scale.h"
+#include "render_cache.h"
+#include "trace.h"
+
+constexpr int THUMBNAIL_SIZE = 120;
+constexpr int THUMBNAIL_MARGIN = 10;
+constexpr int THUMBNAIL_LABEL_HEIGHT = 20;
+constexpr int THUMBNAIL_SLOT_HEIGHT = THUMBNAIL_SIZE + THUMBNAIL_LABEL_HEIGHT + THUMBNAIL_MARGIN;
+
+struct thumbnail_result {
+    int page;
+    int rotation;
+    int generation;
+
+    // the wxImage is only made on the GUI thread, its reference count is not thread safe
+    std::shared_ptr<const page_raster> thumbnail;
+};
+
+wxDEFINE_EVENT(wxEVT_COMMAND_THUMBNAIL_READY, wxThreadEvent);
+
+BEGIN_EVENT_TABLE(thumbnail_panel, wxScrolledCanvas)
+    EVT_LEFT_DOWN(thumbnail_panel::OnLeftDown)
+    EVT_SCROLLWIN(thumbnail_panel::OnScroll)
+    EVT_SIZE(thumbnail_panel::OnSize)
+END_EVENT_TABLE()
+
+thumbnail_thread::thumbnail_thread(wxEvtHandler *parent, std::shared_ptr<thumbnail_jobs> jobs)
+    : wxThread(wxTHREAD_JOINABLE), parent(parent), m_jobs(std::move(jobs)) {}
+
+static page_raster render_thumbnail(pdf_document &doc, int page, int rotation) {
+    TRACE_SCOPE("render_thumbnail");
+    page_raster raster(doc.render_page(page, rotation));
+    double factor = double(THUMBNAIL_SIZE) / std::max(raster.width(), raster.height());
+    page_raster thumbnail(std::max(1, int(raster.width() * factor)), std::max(1, int(raster.height() * factor)), 3);
+    scale_raster(raster.data(), raster.width(), raster.height(), raster.channels(),
+        thumbnail.data(), thumbnail.width(), thumbnail.height(), thumbnail.stride(), pixel_layout{}, true);
+    return thumbnail;
+}
+
+wxThread::ExitCode thumbnail_thread::Entry() {
+    tracer::get().setThreadName("thumbnail");
+
+    std::filesystem::path pdf_filename;
+    uint64_t pdf_hash;
+    int generation;
+    {
+        std::scoped_lock lock(m_jobs->mutex);
+        pdf_filename = m_jobs->pdf_filename;
+        pdf_hash = m_jobs->pdf_hash;
+        generation = m_jobs->generation;
+    }
+
+    // every worker opens its own copy of the document, the renderer is not thread safe
+    pdf_document doc;
+    try {
+        doc.open(pdf_filename.string());
+    } catch (const std::exception &) {
+        return (wxThread::ExitCode) 1;
+    }
+
+    while (true) {
+        int page, rotation;
+        {
+            std::unique_lock lock(m_jobs->mutex);
+            m_jobs->cond.wait(lock, [&]{ return m_jobs->stopped || !m_jobs->pages.empty(); });
+            if (m_jobs->stopped) break;
+            page = m_jobs->pages.front();
+            m_jobs->pages.pop_front();
+            rotation = m_jobs->rotation;
+        }
+
+        render_key key{pdf_hash, page, rotation, THUMBNAIL_SIZE, 3};
+        page_raster thumbnail;
+        if (pdf_hash) {
+            thumbnail = render_cache::get().load(key);
+        }
+        if (!thumbnail) {
+            try {
+                thumbnail = render_thumbnail(doc, page, rotation);
+            } catch (const std::exception &) {
+                continue;
+            }
+            if (pdf_hash) {
+                render_cache::get().store(key, thumbnail);
+            }
+        }
+
+        auto *evt = new wxThreadEvent(wxEVT_COMMAND_THUMBNAIL_READY);
+        evt->SetPayload(thumbnail_result{page, rotation, generation, std::make_shared<const page_raster>(std::move(thumbnail))});
+        wxQueueEvent(parent, evt);
+    }
+    return (wxThread::ExitCode) 0;
+}
+
+thumbnail_panel::thumbnail_panel(wxWindow *parent, frame_editor *app) : wxScrolledCanvas(parent), app(app) {
+    SetScrollRate(0, THUMBNAIL_SLOT_HEIGHT / 4);
+    SetBackgroundColour(wxSystemSettings::GetColour(wxSYS_COLOUR_APPWORKSPACE));
+
+    Bind(wxEVT_COMMAND_THUMBNAIL_READY, &thumbnail_panel::OnThumbnailReady, this);
+}
+
+thumbnail_panel::~thumbnail_panel() {
+    stopThreads();
+}
+
+void thumbnail_panel::loadDocument(const pdf_document &doc, uint64_t pdf_hash, int rotation) {
+    stopThreads();
+
+    int generation = m_jobs ? m_jobs->generation + 1 : 0;
+    m_jobs = std::make_shared<thumbnail_jobs>();
+    m_jobs->pdf_filename = doc.filename();
+    m_jobs->pdf_hash = pdf_hash;
+    m_jobs->rotation = rotation;
+    m_jobs->generation = generation;
+
+    int num_pages = doc.num_pages();
+    for (int page = 1; page <= num_pages; ++page) {
+        m_jobs->pages.push_back(page);
+    }
+
+    m_images.assign(num_pages + 1, wxImage());
+    m_bitmaps.assign(num_pages + 1, wxBitmap());
+
+    SetVirtualSize(THUMBNAIL_SIZE + 2 * THUMBNAIL_MARGIN, num_pages * THUMBNAIL_SLOT_HEIGHT + THUMBNAIL_MARGIN);
+    startThreads();
+    queueVisiblePages();
+    Refresh();
+}
+
+void thumbnail_panel::setRotation(int rotation) {
+    if (!m_jobs) return;
+
+    // every page is rendered again in the new rotation, the visible ones first
+    {
+        std::scoped_lock lock(m_jobs->mutex);
+        m_jobs->rotation = rotation;
+        m_jobs->pages.clear();
+        for (int page = 1; page < int(m_images.size()); ++page) {
+            m_jobs->pages.push_back(page);
+        }
+    }
+    m_images.assign(m_images.size(), wxImage());
+    m_bitmaps.assign(m_bitmaps.size(), wxBitmap());
+    queueVisiblePages();
+    Refresh();
+}
+
+void thumbnail_panel::setSelectedPage(int page) {
+    m_selected_page = page;
+    if (page > 0 && page < int(m_images.size())) {
+        int unit_x, unit_y;
+        GetScrollPixelsPerUnit(&unit_x, &unit_y);
+        wxRect rect = getPageRect(page);
+        int view_y = GetViewStart().y * unit_y;
+        if (unit_y > 0 && (rect.GetTop() < view_y || rect.GetBottom() > view_y + GetClientSize().GetHeight())) {
+            Scroll(-1, (rect.GetTop() - THUMBNAIL_MARGIN) / unit_y);
+            queueVisiblePages();
+        }
+    }
+    Refresh();
+}
+
+const wxImage &thumbnail_panel::getThumbnail(int page) const {
+    static const wxImage empty;
+    if (page <= 0 || page >= int(m_images.size())) return empty;
+    return m_images[page];
+}
+
+void thumbnail_panel::startThreads() {
+    int num_threads = std::clamp(wxThread::GetCPUCount() - 1, 1, 3);
+    for (int i = 0; i < num_threads; ++i) {
+        auto *thread = new thumbnail_thread(this, m_jobs);
+        if (thread->Run() != wxTHREAD_NO_ERROR) {
+            delete thread;
+            break;
+        }
+        m_threads.push_back(thread);
+    }
+}
+
+void thumbnail_panel::stopThreads() {
+    if (m_jobs) {
+        std::scoped_lock lock(m_jobs->mutex);
+        m_jobs->stopped = true;
+        m_jobs->pages.clear();
+    }
+    if (m_jobs) {
+        m_jobs->cond.notify_all();
+    }
+    for (thumbnail_thread *thread : m_threads) {
+        thread->Wait();
+        delete thread;
+    }
+    m_threads.clear();
+}
+
+// moves the pages in view to the front of the queue, so that they are rendered first
+void thumbnail_panel::queueVisiblePages() {
+    if (!m_jobs || m_images.size() <= 1) return;
+
+    wxPoint top = CalcUnscrolledPosition(wxPoint(0, 0));
+    int first = std::max(1, (top.y - THUMBNAIL_MARGIN) / THUMBNAIL_SLOT_HEIGHT + 1);
+    int last = std::min(int(m_images.size()) - 1, (top.y + GetClientSize().GetHeight()) / THUMBNAIL_SLOT_HEIGHT + 1);
+
+    {
+        std::scoped_lock lock(m_jobs->mutex);
+        auto &pages = m_jobs->pages;
+        for (int page = last; page >= first; --page) {
+            auto it = std::ranges::find(pages, page);
+            if (it != pages.end()) {
+                pages.erase(it);
+                pages.push_front(page);
+            }
+        }
+    }
+    m_jobs->cond.notify_all();
+}
+
+wxRect thumbnail_panel::getPageRect(int page) const {
+    return wxRect(THUMBNAIL_MARGIN, THUMBNAIL_MARGIN + (page - 1) * THUMBNAIL_SLOT_HEIGHT, THUMBNAIL_SIZE, THUMBNAIL_SIZE);
+}
+
+void thumbnail_panel::OnDraw(wxDC &dc) {
+    int num_pages = int(m_images.size()) - 1;
+    if (num_pages <= 0) return;
+
+    std::vector<int> box_counts(num_pages + 1, 0);
+    for (const layout_box &box : app->layout) {
+        if (box.page > 0 && box.page <= num_pages) {
+            ++box_counts[box.page];
+        }
+    }
+
+    wxPoint top = CalcUnscrolledPosition(wxPoint(0, 0));
+    int first = std::max(1, (top.y - THUMBNAIL_MARGIN) / THUMBNAIL_SLOT_HEIGHT + 1);
+    int last = std::min(num_pages, (top.y + GetClientSize().GetHeight()) / THUMBNAIL_SLOT_HEIGHT + 1);
+
+    for (int page = first; page <= last; ++page) {
+        wxRect rect = getPageRect(page);
+        if (m_images[page].IsOk()) {
+            if (!m_bitmaps[page].IsOk()) {
+                m_bitmaps[page] = wxBitmap(m_images[page]);
+            }
+            const wxBitmap &bitmap = m_bitmaps[page];
+            int x = rect.GetLeft() + (rect.GetWidth() - bitmap.GetWidth()) / 2;
+            int y = rect.GetTop() + (rect.GetHeight() - bitmap.GetHeight()) / 2;
+            dc.DrawBitmap(bitmap, x, y);
+            rect = wxRect(x, y, bitmap.GetWidth(), bitmap.GetHeight());
+        } else {
+            dc.SetPen(*wxLIGHT_GREY_PEN);
+            dc.SetBrush(*wxWHITE_BRUSH);
+            dc.DrawRectangle(rect);
+        }
+        if (page == m_selected_page) {
+            dc.SetPen(wxPen(wxSystemSettings::GetColour(wxSYS_COLOUR_HIGHLIGHT), 3));
+            dc.SetBrush(*wxTRANSPARENT_BRUSH);
+            dc.DrawRectangle(rect.Inflate(2));
+        }
+        dc.DrawLabel(wxintl::translate("THUMBNAIL_LABEL", page, box_counts[page]),
+            wxRect(THUMBNAIL_MARGIN, getPageRect(page).GetBottom(), THUMBNAIL_SIZE, THUMBNAIL_LABEL_HEIGHT),
+            wxALIGN_CENTER);
+    }
+}
+
+void thumbnail_panel::OnLeftDown(wxMouseEvent &evt) {
+    wxPoint pt = CalcUnscrolledPosition(evt.GetPosition());
+    int page = (pt.y - THUMBNAIL_MARGIN) / THUMBNAIL_SLOT_HEIGHT + 1;
+    if (pt.y >= THUMBNAIL_MARGIN && page < int(m_images.size())) {
+        app->setSelectedPage(page);
+    }
+    evt.Skip();
+}
+
+void thumbnail_panel::OnScroll(wxScrollWinEvent &evt) {
+    CallAfter(&thumbnail_panel::queueVisiblePages);
+    evt.Skip();
+}
+
+void thumbnail_panel::OnSize(wxSizeEvent &evt) {
+    queueVisiblePages();
+    evt.Skip();
+}
+
+void thumbnail_panel::OnThumbnailReady(wxThreadEvent &evt) {
+    auto result = evt.GetPayload<thumbnail_result>();
+    if (!m_jobs || result.generation != m_jobs->generation) return;
+    if (result.page <= 0 || result.page >= int(m_images.size())) return;
+
+    // the view was rotated while this page was rendering, it is already queued again
+    {
+        std::scoped_lock lock(m_jobs->mutex);
+        if (result.rotation != m_jobs->rotation) return;
+    }
+    const page_raster &thumbnail = *result.thumbnail;
+    wxImage image(thumbnail.width(), thumbnail.height(), false);
+    memcpy(image.GetData(), thumbnail.data(), thumbnail.size_bytes());
+    m_images[result.page] = std::move(image);
+    m_bitmaps[result.page] = wxBitmap();
+    RefreshRect(wxRect(CalcScrolledPosition(getPageRect(result.page).GetTopLeft()), getPageRect(result.page).GetSize()));
+}
\ No newline at end of file
@@ -0,0 +1,84 @@
+#ifndef __THUMBNAIL_PANEL_H__
+#define __THUMBNAIL_PANEL_H__
+
+#include <wx/scrolwin.h>
+#include <wx/thread.h>
+#include <wx/bitmap.h>
+#include <wx/image.h>
+
+#include <deque>
+#include <vector>
+#include <mutex>
+#include <condition_variable>
+#include <filesystem>
+#include <memory>
+
+#include "pdf_document.h"
+
+using namespace bls;
+
+// Work shared between the thumbnail panel and its worker threads
+struct thumbnail_jobs {
+    std::mutex mutex;
+    std::condition_variable cond;
+    std::deque<int> pages;
+    bool stopped = false;
+
+    std::filesystem::path pdf_filename;
+    uint64_t pdf_hash = 0;
+    int rotation = 0;
+    int generation = 0;
+};
+
+class thumbnail_thread : public wxThread {
+public:
+    thumbnail_thread(wxEvtHandler *parent, std::shared_ptr<thumbnail_jobs> jobs);
+
+protected:
+    virtual ExitCode Entry() override;
+
+private:
+    wxEvtHandler *parent;
+    std::shared_ptr<thumbnail_jobs> m_jobs;
+};
+
+class thumbnail_panel : public wxScrolledCanvas {
+public:
+    thumbnail_panel(wxWindow *parent, class frame_editor *app);
+    ~thumbnail_panel();
+
+    void loadDocument(const pdf_document &doc, uint64_t pdf_hash, int rotation);
+    void setRotation(int rotation);
+    void setSelectedPage(int page);
+
+    // returns an invalid image if the page has not been rendered yet
+    const wxImage &getThumbnail(int page) const;
+
+private:
+    void startThreads();
+    void stopThreads();
+    void queueVisiblePages();
+
+    wxRect getPageRect(int page) const;
+
+    virtual void OnDraw(wxDC &dc) override;
+
+    void OnLeftDown(wxMouseEvent &evt);
+    void OnScroll(wxScrollWinEvent &evt);
+    void OnSize(wxSizeEvent &evt);
+    void OnThumbnailReady(wxThreadEvent &evt);
+
+private:
+    class frame_editor *app;
+
+    std::shared_ptr<thumbnail_jobs> m_jobs;
+    std::vector<thumbnail_thread *> m_threads;
+
+    std::vector<wxImage> m_images;
+    std::vector<wxBitmap> m_bitmaps;
+    int m_selected_page = 0;
+
+    DECLARE_EVENT_TABLE()
+};
+
+#endif
\ No newline at end of file
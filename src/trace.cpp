@@ -0,0 +1,102 @@
+#include "trace.h"
+
+#include <algorithm>
+#include <format>
+
+#include "file_utils.h"
+#include "json_utils.h"
+
+tracer &tracer::get() {
+    static tracer instance;
+    return instance;
+}
+
+tracer::tracer() : m_epoch_ns(now()) {}
+
+// buffers of finished threads are handed to the next new thread, so that the editor
+// starting a thread per read or per render does not grow the tracer without bounds.
+// The new thread keeps the track id of the buffer and replaces its name
+tracer::thread_slot::~thread_slot() {
+    if (buffer) {
+        buffer->retired.store(true, std::memory_order_release);
+    }
+}
+
+tracer::thread_buffer *tracer::threadBuffer() {
+    thread_local thread_slot slot;
+    if (!slot.buffer) {
+        std::scoped_lock lock(m_mutex);
+        auto it = std::ranges::find_if(m_buffers, [](const auto &buffer) {
+            return buffer->retired.load(std::memory_order_acquire);
+        });
+        if (it == m_buffers.end()) {
+            it = m_buffers.insert(m_buffers.end(), std::make_unique<thread_buffer>());
+            (*it)->tid = m_next_tid++;
+        }
+        slot.buffer = it->get();
+        slot.buffer->retired.store(false, std::memory_order_relaxed);
+        slot.buffer->name.clear();
+    }
+    return slot.buffer;
+}
+
+void tracer::record(const char *name, int64_t begin_ns, int64_t end_ns) {
+    thread_buffer *buffer = threadBuffer();
+    uint64_t head = buffer->head.load(std::memory_order_relaxed);
+    buffer->spans[head % BUFFER_SIZE] = span{name, begin_ns, end_ns, buffer->tid};
+    buffer->head.store(head + 1, std::memory_order_release);
+}
+
+void tracer::setThreadName(const std::string &name) {
+    thread_buffer *buffer = threadBuffer();
+    std::scoped_lock lock(m_mutex);
+    buffer->name = name;
+}
+
+void tracer::exportChrome(const std::filesystem::path &filename) {
+    std::vector<span> spans;
+    std::vector<std::pair<int, std::string>> thread_names;
+    {
+        std::scoped_lock lock(m_mutex);
+        for (const auto &buffer : m_buffers) {
+            if (!buffer->name.empty()) {
+                thread_names.emplace_back(buffer->tid, buffer->name);
+            }
+            uint64_t head = buffer->head.load(std::memory_order_acquire);
+            uint64_t first = head > BUFFER_SIZE ? head - BUFFER_SIZE : 0;
+            size_t begin = spans.size();
+            for (uint64_t i = first; i < head; ++i) {
+                spans.push_back(buffer->spans[i % BUFFER_SIZE]);
+            }
+
+            // the owner may have kept recording meanwhile, its newest spans replaced the oldest copied ones
+            std::atomic_thread_fence(std::memory_order_acquire);
+            uint64_t head_after = buffer->head.load(std::memory_order_relaxed);
+            if (head_after + 1 > first + BUFFER_SIZE) {
+                size_t overwritten = std::min<uint64_t>(head_after + 1 - BUFFER_SIZE - first, head - first);
+                spans.erase(spans.begin() + begin, spans.begin() + begin + overwritten);
+            }
+        }
+    }
+
+    std::string out = "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+    bool first = true;
+    for (const auto &[tid, name] : thread_names) {
+        if (!first) out += ',';
+        first = false;
+        out += std::format("{{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":{},\"args\":{{\"name\":", tid);
+        append_json_string(out, name);
+        out += "}}";
+    }
+    for (const span &s : spans) {
+        if (!first) out += ',';
+        first = false;
+        out += "{\"name\":";
+        append_json_string(out, s.name);
+        out += std::format(",\"ph\":\"X\",\"pid\":1,\"tid\":{},\"ts\":{:.3f},\"dur\":{:.3f}}}",
+            s.tid, (s.begin_ns - m_epoch_ns) / 1000.0, (s.end_ns - s.begin_ns) / 1000.0);
+    }
+    out += "]}\n";
+
+    atomic_write_file(filename, out);
+}
\ No newline at end of file
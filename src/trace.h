@@ -0,0 +1,90 @@
+#ifndef __TRACE_H__
+#define __TRACE_H__
+
+#include <atomic>
+#include <chrono>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// Scoped timing spans of the editor, kept in a ring buffer per thread.
+// Recording a span is two clock reads and a few stores into the buffer of the calling thread,
+// only the first span of a thread takes a lock to register its buffer.
+// The most recent spans of every thread can be exported as Chrome trace-event JSON,
+// to be opened in chrome://tracing or Perfetto.
+class tracer {
+public:
+    static tracer &get();
+
+    static int64_t now() {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    // name must be a string literal, or outlive the tracer
+    void record(const char *name, int64_t begin_ns, int64_t end_ns);
+
+    // shown as the name of the calling thread in the exported trace
+    void setThreadName(const std::string &name);
+
+    // throws std::runtime_error if the file can't be written
+    void exportChrome(const std::filesystem::path &filename);
+
+private:
+    tracer();
+
+    static constexpr size_t BUFFER_SIZE = 4096;
+
+    struct span {
+        const char *name;
+        int64_t begin_ns;
+        int64_t end_ns;
+        int tid;
+    };
+
+    // written only by the thread that owns it, the exporter discards the slots
+    // that may have been overwritten while it was copying them
+    struct thread_buffer {
+        span spans[BUFFER_SIZE];
+        std::atomic<uint64_t> head = 0;
+        std::atomic<bool> retired = false;
+        int tid = 0;
+        std::string name;   // guarded by m_mutex
+    };
+
+    struct thread_slot {
+        thread_buffer *buffer = nullptr;
+        ~thread_slot();
+    };
+
+    thread_buffer *threadBuffer();
+
+private:
+    std::mutex m_mutex;
+    std::vector<std::unique_ptr<thread_buffer>> m_buffers;
+    int m_next_tid = 1;
+    int64_t m_epoch_ns;
+};
+
+class trace_scope {
+public:
+    explicit trace_scope(const char *name) : m_name(name), m_begin(tracer::now()) {}
+
+    ~trace_scope() {
+        tracer::get().record(m_name, m_begin, tracer::now());
+    }
+
+    trace_scope(const trace_scope &) = delete;
+    trace_scope &operator = (const trace_scope &) = delete;
+
+private:
+    const char *m_name;
+    int64_t m_begin;
+};
+
+#define TRACE_CONCAT_IMPL(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_IMPL(a, b)
+#define TRACE_SCOPE(name) trace_scope TRACE_CONCAT(trace_scope_, __LINE__)(name)
+
+#endif
\ No newline at end of file
@@ -0,0 +1,122 @@
+#include "trigram_index.h"
+
+#include <algorithm>
+#include <iterator>
+
+static char fold(char c) {
+    return (c >= 'A' && c <= 'Z') ? char(c - 'A' + 'a') : c;
+}
+
+static uint32_t trigram_at(std::string_view str, size_t i) {
+    return uint32_t(uint8_t(str[i])) << 16 | uint32_t(uint8_t(str[i + 1])) << 8 | uint32_t(uint8_t(str[i + 2]));
+}
+
+uint32_t trigram_index::add(std::string_view text) {
+    if (m_offsets.empty()) m_offsets.push_back(0);
+    for (char c : text) {
+        m_text += fold(c);
+    }
+    m_offsets.push_back(uint32_t(m_text.size()));
+    return uint32_t(m_offsets.size() - 2);
+}
+
+void trigram_index::build() {
+    // (trigram << 32 | id) in id order, a stable sort on the trigram bytes keeps the ids of each trigram sorted
+    std::vector<uint64_t> pairs, sorted;
+    for (uint32_t id = 0; id < size(); ++id) {
+        std::string_view str = text(id);
+        for (size_t i = 0; i + 3 <= str.size(); ++i) {
+            pairs.push_back(uint64_t(trigram_at(str, i)) << 32 | id);
+        }
+    }
+    sorted.resize(pairs.size());
+    for (int shift = 32; shift < 56; shift += 8) {
+        size_t counts[257] = {};
+        for (uint64_t pair : pairs) {
+            ++counts[((pair >> shift) & 0xff) + 1];
+        }
+        for (size_t i = 1; i < 257; ++i) {
+            counts[i] += counts[i - 1];
+        }
+        for (uint64_t pair : pairs) {
+            sorted[counts[(pair >> shift) & 0xff]++] = pair;
+        }
+        pairs.swap(sorted);
+    }
+
+    m_trigrams.clear();
+    m_starts.clear();
+    m_ids.clear();
+    m_ids.reserve(pairs.size());
+    for (uint64_t pair : pairs) {
+        uint32_t trigram = uint32_t(pair >> 32);
+        uint32_t id = uint32_t(pair);
+        if (m_trigrams.empty() || m_trigrams.back() != trigram) {
+            m_trigrams.push_back(trigram);
+            m_starts.push_back(uint32_t(m_ids.size()));
+        } else if (m_ids.back() == id) {
+            // the trigram appears more than once in the string
+            continue;
+        }
+        m_ids.push_back(id);
+    }
+    m_starts.push_back(uint32_t(m_ids.size()));
+}
+
+void trigram_index::clear() {
+    m_text.clear();
+    m_offsets.clear();
+    m_trigrams.clear();
+    m_starts.clear();
+    m_ids.clear();
+}
+
+std::vector<uint32_t> trigram_index::search(std::string_view query, size_t max_results) const {
+    std::string folded(query);
+    std::ranges::transform(folded, folded.begin(), fold);
+
+    std::vector<uint32_t> ret;
+    auto check = [&](uint32_t id) {
+        if (text(id).find(folded) != std::string_view::npos) {
+            ret.push_back(id);
+        }
+        return ret.size() < max_results;
+    };
+
+    if (folded.size() < 3) {
+        for (uint32_t id = 0; id < size(); ++id) {
+            if (!check(id)) break;
+        }
+        return ret;
+    }
+
+    // the postings of the query's trigrams, shortest first
+    std::vector<std::pair<const uint32_t *, const uint32_t *>> lists;
+    for (size_t i = 0; i + 3 <= folded.size(); ++i) {
+        auto it = std::ranges::lower_bound(m_trigrams, trigram_at(folded, i));
+        if (it == m_trigrams.end() || *it != trigram_at(folded, i)) return ret;
+        size_t index = it - m_trigrams.begin();
+        lists.emplace_back(m_ids.data() + m_starts[index], m_ids.data() + m_starts[index + 1]);
+    }
+    std::ranges::sort(lists, {}, [](const auto &list) { return list.second - list.first; });
+
+    // set_intersection may not write over its inputs, the two vectors take turns
+    std::vector<uint32_t> candidates(lists.front().first, lists.front().second);
+    std::vector<uint32_t> scratch;
+    scratch.reserve(candidates.size());
+    for (size_t i = 1; i < lists.size() && !candidates.empty(); ++i) {
+        scratch.clear();
+        std::set_intersection(candidates.begin(), candidates.end(), lists[i].first, lists[i].second, std::back_inserter(scratch));
+        candidates.swap(scratch);
+    }
+
+    // the trigrams may appear apart from each other, only the text can tell
+    for (uint32_t id : candidates) {
+        if (!check(id)) break;
+    }
+    return ret;
+}
+
+size_t trigram_index::memoryUsage() const {
+    return m_text.capacity() + (m_offsets.capacity() + m_trigrams.capacity() + m_starts.capacity() + m_ids.capacity()) * sizeof(uint32_t);
+}
\ No newline at end of file
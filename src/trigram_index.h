@@ -0,0 +1,50 @@
+#ifndef __TRIGRAM_INDEX_H__
+#define __TRIGRAM_INDEX_H__
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Case insensitive substring search over a fixed set of strings.
+// Every string is cut into its overlapping three byte sequences, and each sequence
+// lists the strings that contain it, so a query only checks the strings that have
+// all of its sequences. Queries shorter than three bytes check every string.
+// ASCII letters are folded to lower case, other bytes compare as they are.
+class trigram_index {
+public:
+    // returns the id of the string, ids count up from 0
+    uint32_t add(std::string_view text);
+
+    // must be called after the last add and before the first search
+    void build();
+
+    void clear();
+
+    // ids of the strings that contain query, in increasing order
+    std::vector<uint32_t> search(std::string_view query, size_t max_results = SIZE_MAX) const;
+
+    size_t size() const {
+        return m_offsets.empty() ? 0 : m_offsets.size() - 1;
+    }
+
+    size_t memoryUsage() const;
+
+private:
+    std::string_view text(uint32_t id) const {
+        return std::string_view(m_text).substr(m_offsets[id], m_offsets[id + 1] - m_offsets[id]);
+    }
+
+private:
+    // the folded strings back to back
+    std::string m_text;
+    std::vector<uint32_t> m_offsets;
+
+    // postings of each trigram, sorted by trigram, the ids of trigram i are
+    // m_ids[m_starts[i]] to m_ids[m_starts[i + 1]]
+    std::vector<uint32_t> m_trigrams;
+    std::vector<uint32_t> m_starts;
+    std::vector<uint32_t> m_ids;
+};
+
+#endif
\ No newline at end of file
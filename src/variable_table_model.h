@@ -3,6 +3,11 @@
 
 #include <wx/dataview.h>
 #include "reader.h"
+#include "perf_counters.h"
+#include "trigram_index.h"
+
+// most search results shown at once, building more rows than this makes typing lag
+constexpr size_t MAX_SEARCH_RESULTS = 5000;
 
 struct VariableTableModelNode {
     VariableTableModelNode *parent = nullptr;
@@ -12,6 +17,12 @@ struct VariableTableModelNode {
     wxString value;
     std::list<VariableTableModelNode> children;
 
+    // children are made from their source when the node is expanded, and dropped
+    // when the node is released, the source must outlive the node
+    const variable_map *source_table = nullptr;
+    const variable *source_array = nullptr;
+    bool populated = false;
+
     VariableTableModelNode(VariableTableModelNode *parent, const wxString &name, const wxString &type = wxEmptyString, const wxString &value = wxEmptyString)
         : parent(parent), name(name), type(type), value(value) {}
 
@@ -19,19 +30,54 @@ struct VariableTableModelNode {
         : parent(parent), name(name), type(wxintl::enum_label(var.type())), value(wxintl::to_wx(var.as_view()))
     {
         if (var.is_array()) {
-            const auto &arr = var.as_array();
+            source_array = &var;
+        }
+    }
+
+    VariableTableModelNode(VariableTableModelNode *parent, const wxString &name, const variable_map &table)
+        : parent(parent), name(name), source_table(&table) {}
+
+    bool hasChildren() const {
+        if (source_table) return !source_table->empty();
+        if (source_array) return !source_array->as_array().empty();
+        return !children.empty();
+    }
+
+    // returns the approximate bytes of the children that were added
+    int64_t populate() {
+        if (populated) return 0;
+        populated = true;
+        if (source_table) {
+            for (const auto &[key, val] : *source_table) {
+                children.emplace_back(this, wxintl::to_wx(key), val);
+            }
+        } else if (source_array) {
+            const auto &arr = source_array->as_array();
             for (size_t i=0; i<arr.size(); ++i) {
                 children.emplace_back(this, std::format("[{}]", i), arr[i]);
             }
         }
+        int64_t bytes = 0;
+        for (const auto &child : children) {
+            bytes += child.memoryUsage();
+        }
+        return bytes;
     }
 
-    VariableTableModelNode(VariableTableModelNode *parent, const wxString &name, const variable_map &table)
-        : parent(parent), name(name)
-    {
-        for (const auto &[key, val] : table) {
-            children.emplace_back(this, wxintl::to_wx(key), val);
+    // drops the children and their descendants, returns their approximate bytes
+    int64_t release() {
+        int64_t bytes = 0;
+        for (auto &child : children) {
+            bytes += child.release() + child.memoryUsage();
         }
+        children.clear();
+        populated = false;
+        return bytes;
+    }
+
+    int64_t memoryUsage() const {
+        return sizeof(VariableTableModelNode) + 2 * sizeof(void *)
+            + (name.length() + type.length() + value.length()) * sizeof(wxStringCharType);
     }
 };
 
@@ -39,28 +85,152 @@ class VariableTableModel : public wxDataViewModel {
 private:
     std::list<VariableTableModelNode> m_root;
 
-    void RecurseUpdateItems(const VariableTableModelNode &node) {
-        ItemAdded(wxDataViewItem((void *) node.parent), wxDataViewItem((void *) &node));
-        for (const VariableTableModelNode &child : node.children) {
-            RecurseUpdateItems(child);
+    // the tables are borrowed from the reader, the nodes are built from them on demand.
+    // They must stay unchanged until ClearTables is called
+    std::vector<const variable_map *> m_tables;
+
+    // approximate heap usage of the nodes, reported to the memory accounting
+    mutable int64_t m_bytes = 0;
+
+    // every variable of the tables, with its path, searched through the trigram index
+    struct search_entry {
+        const variable *var;
+        size_t table;
+        std::string name;
+    };
+    std::vector<search_entry> m_entries;
+    trigram_index m_index;
+    int64_t m_index_bytes = 0;
+
+    // while a search is active, the root shows the matching variables instead of the tables
+    std::list<VariableTableModelNode> m_results;
+    bool m_searching = false;
+
+    void addBytes(int64_t bytes) const {
+        m_bytes += bytes;
+        perf_counters::get().output_model_bytes += bytes;
+    }
+
+    void releaseCollapsed(const wxDataViewCtrl *ctrl, std::list<VariableTableModelNode> &nodes) {
+        for (auto &node : nodes) {
+            if (!node.populated) continue;
+            wxDataViewItem item((void *) &node);
+            if (ctrl->IsExpanded(item)) {
+                releaseCollapsed(ctrl, node.children);
+            } else {
+                // the control is told before the children are freed, while their items are still valid
+                wxDataViewItemArray items;
+                for (const auto &child : node.children) {
+                    items.Add(wxDataViewItem((void *) &child));
+                }
+                ItemsDeleted(item, items);
+                addBytes(-node.release());
+            }
+        }
+    }
+
+    // the ids of the index are the positions in m_entries, so both are appended together
+    void indexVariable(size_t table, const std::string &name, const variable &var) {
+        std::string text = name;
+        text += '\x1f';
+        if (!var.is_array()) {
+            text.append(var.as_view());
+        }
+        m_index.add(text);
+        m_entries.push_back({&var, table, name});
+        m_index_bytes += sizeof(search_entry) + name.capacity();
+
+        if (var.is_array()) {
+            const auto &arr = var.as_array();
+            for (size_t i=0; i<arr.size(); ++i) {
+                indexVariable(table, std::format("{}[{}]", name, i), arr[i]);
+            }
         }
     }
 
+    void clearResults() {
+        for (auto &node : m_results) {
+            addBytes(-(node.release() + node.memoryUsage()));
+        }
+        m_results.clear();
+    }
+
 public:
+    ~VariableTableModel() {
+        perf_counters::get().output_model_bytes -= m_bytes;
+    }
+
     void AddTable(const wxString &name, const variable_map &table) {
-        RecurseUpdateItems(m_root.emplace_back(nullptr, name, table));
+        m_tables.push_back(&table);
+        auto &node = m_root.emplace_back(nullptr, name, table);
+        addBytes(node.memoryUsage());
+        ItemAdded(wxDataViewItem(nullptr), wxDataViewItem((void *) &node));
     }
 
     void ClearTables() {
+        m_results.clear();
+        m_searching = false;
+        m_entries.clear();
+        m_index.clear();
+        m_index_bytes = 0;
         m_root.clear();
+        m_tables.clear();
+        addBytes(-m_bytes);
+
+        Cleared();
+    }
+
+    // frees the nodes under every collapsed node of the control, they are built again when expanded
+    void ReleaseCollapsed(const wxDataViewCtrl *ctrl) {
+        releaseCollapsed(ctrl, m_searching ? m_results : m_root);
+    }
+
+    // indexes the names and values of every variable of the tables, once all of them were added
+    void BuildIndex() {
+        addBytes(-m_index_bytes);
+        m_index_bytes = 0;
+        m_entries.clear();
+        m_index.clear();
+        size_t table_number = 0;
+        for (const variable_map *table : m_tables) {
+            ++table_number;
+            for (const auto &[key, val] : *table) {
+                indexVariable(table_number, std::string(key), val);
+            }
+        }
+        m_index.build();
+        m_index_bytes += m_index.memoryUsage();
+        addBytes(m_index_bytes);
+    }
 
+    // shows the variables whose name or value contains query, or the tables if query is empty.
+    // Returns the number of matches, at most MAX_SEARCH_RESULTS + 1
+    size_t Search(std::string_view query) {
+        clearResults();
+        m_searching = !query.empty();
+
+        size_t count = 0;
+        if (m_searching) {
+            auto ids = m_index.search(query, MAX_SEARCH_RESULTS + 1);
+            count = ids.size();
+            ids.resize(std::min(ids.size(), MAX_SEARCH_RESULTS));
+            for (uint32_t id : ids) {
+                const search_entry &entry = m_entries[id];
+                auto &node = m_results.emplace_back(nullptr, wxintl::translate("SEARCH_RESULT_NAME", entry.table, entry.name), *entry.var);
+                addBytes(node.memoryUsage());
+            }
+        }
         Cleared();
+        return count;
     }
 
     virtual unsigned int GetChildren(const wxDataViewItem &item, wxDataViewItemArray &children) const override {
         VariableTableModelNode *node = (VariableTableModelNode *) item.GetID();
+        if (node) {
+            addBytes(node->populate());
+        }
 
-        const std::list<VariableTableModelNode> *list = node ? &node->children : &m_root;
+        const std::list<VariableTableModelNode> *list = node ? &node->children : m_searching ? &m_results : &m_root;
         size_t count = 0;
         for (const VariableTableModelNode &c : *list) {
             children.Add(wxDataViewItem((void *) &c));
@@ -99,7 +269,7 @@ public:
         VariableTableModelNode *node = (VariableTableModelNode *) item.GetID();
         if (!node) return true;
 
-        return !node->children.empty();
+        return node->hasChildren();
     }
 
     virtual bool SetValue(const wxVariant &, const wxDataViewItem &, unsigned int) override {